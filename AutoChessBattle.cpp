@@ -0,0 +1,208 @@
+#include "AutoChessBattle.h"
+#include "GamesRandom.h"
+
+static_assert(BATTLE_MAX_UNITS <= 16, "BattleTeam::alive has a bit per unit");
+
+// Predefined units for Auto Chess
+const AutoChessUnitTemplate UNIT_TEMPLATES[] = {
+    {"Knight", 3, 100, 15, 50, UnitRace::Human, UnitClass::Warrior},
+    {"Archer", 2, 70, 20, 40, UnitRace::Elf, UnitClass::Ranger},
+    {"Mage", 4, 60, 25, 80, UnitRace::Human, UnitClass::Mage},
+    {"Orc Warrior", 3, 120, 18, 30, UnitRace::Orc, UnitClass::Warrior},
+    {"Druid", 3, 80, 15, 60, UnitRace::Elf, UnitClass::Mage},
+    {"Assassin", 4, 65, 30, 50, UnitRace::Human, UnitClass::Assassin},
+    {"Troll", 2, 90, 12, 40, UnitRace::Orc, UnitClass::Warrior},
+    {"Priest", 3, 75, 10, 70, UnitRace::Human, UnitClass::Mage},
+    {"Ranger", 2, 70, 18, 45, UnitRace::Elf, UnitClass::Ranger},
+    {"Berserker", 4, 110, 25, 35, UnitRace::Orc, UnitClass::Warrior}
+};
+
+// Indexed by Synergy
+const int SYNERGY_THRESHOLDS[SYNERGY_COUNT] = {WARRIOR_SYNERGY_THRESHOLD, TROLL_SYNERGY_THRESHOLD, ELF_SYNERGY_THRESHOLD,
+                                               KNIGHT_SYNERGY_THRESHOLD, MAGE_SYNERGY_THRESHOLD};
+
+void AutoChessSynergies::update(const AutoChessUnitTemplate &unit, int delta)
+{
+    bool member[SYNERGY_COUNT] = {unit.unitClass == UnitClass::Warrior, unit.race == UnitRace::Orc, unit.race == UnitRace::Elf,
+                                  unit.race == UnitRace::Human, unit.unitClass == UnitClass::Mage};
+    for (size_t i = 0; i < SYNERGY_COUNT; i++) {
+        if (!member[i])
+            continue;
+        counts[i] += delta;
+        if (counts[i] >= SYNERGY_THRESHOLDS[i])
+            active |= 1u << i;
+        else
+            active &= ~(1u << i);
+    }
+}
+
+// Board units as a battle team. Damage per hit is worked out once, with the
+// same float steps a hit used to take, so battles play out exactly as before.
+void fillBattleTeam(BattleTeam &team, const AutoChessUnit *units, size_t count, const AutoChessSynergies &own,
+                    const AutoChessSynergies &defender)
+{
+    float damageReduction = defender.has(Synergy::Warriors) ? WARRIOR_DAMAGE_REDUCTION : 0.0f;
+    float knightReduction = defender.has(Synergy::Knights) ? KNIGHT_DAMAGE_REDUCTION : 0.0f;
+    float attackSpeed = own.has(Synergy::Trolls) ? TROLL_ATTACK_SPEED_BONUS : 0.0f;
+    float mageBoost = own.has(Synergy::Mages) ? MAGE_DAMAGE_BOOST : 0.0f;
+
+    team.alive = 0;
+    team.dodges = own.has(Synergy::Elves);
+    for (size_t i = 0; i < count && i < BATTLE_MAX_UNITS; i++) {
+        const auto &unit = units[i];
+        int damage = UNIT_TEMPLATES[unit.templateId].damage * (1.0f - damageReduction - knightReduction);
+        if (attackSpeed > 0) {
+            damage = static_cast<int>(damage * (1.0f + attackSpeed));
+        }
+        if (mageBoost > 0 && UNIT_TEMPLATES[unit.templateId].unitClass == UnitClass::Mage) {
+            damage = static_cast<int>(damage * (1.0f + mageBoost));
+        }
+        team.health[i] = unit.health;
+        team.damage[i] = damage;
+        team.alive |= 1u << i;
+    }
+}
+
+bool elfDodge(void *rng)
+{
+    return static_cast<GamesRandom *>(rng)->unit() < ELF_DODGE_CHANCE;
+}
+
+static int teamHealth(const BattleTeam &team)
+{
+    int total = 0;
+    for (uint16_t alive = team.alive; alive; alive &= alive - 1)
+        total += team.health[__builtin_ctz(alive)];
+    return total;
+}
+
+static void attack(const BattleTeam &attacker, BattleTeam &defender, int side, BattleDodge dodge, void *context,
+                   BattleLog *log)
+{
+    for (uint16_t attackers = attacker.alive; attackers && defender.alive; attackers &= attackers - 1) {
+        int unit = __builtin_ctz(attackers);
+        BattleEvent event = BattleEvent::Dodge;
+        if (!defender.dodges || !dodge(context)) {
+            int front = __builtin_ctz(defender.alive);
+            defender.health[front] -= attacker.damage[unit];
+            event = BattleEvent::Hit;
+            if (defender.health[front] <= 0) {
+                defender.alive &= ~(1u << front);
+                event = BattleEvent::Kill;
+            }
+        }
+        if (log)
+            log->record(packBattleEvent(event, side, unit));
+    }
+}
+
+BattleResult runBattle(BattleTeam &team1, BattleTeam &team2, BattleDodge dodge, void *context, BattleLog *log)
+{
+    BattleResult result = {};
+    int start1 = teamHealth(team1);
+    int start2 = teamHealth(team2);
+
+    while (team1.alive && team2.alive && result.rounds < BATTLE_MAX_ROUNDS) {
+        attack(team1, team2, 0, dodge, context, log);
+        attack(team2, team1, 1, dodge, context, log);
+        result.rounds++;
+    }
+
+    int left1 = teamHealth(team1);
+    int left2 = teamHealth(team2);
+    result.healthLost[0] = start1 - left1;
+    result.healthLost[1] = start2 - left2;
+
+    // A battle stopped by the round cap goes to the side with more health left
+    result.team1Won = team1.alive && (!team2.alive || left1 >= left2);
+    return result;
+}
+
+// Bounds-checked little endian writer and reader for the log format
+namespace
+{
+struct LogWriter {
+    uint8_t *out;
+    size_t len;
+    size_t pos = 0;
+
+    void put(uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++, pos++) {
+            if (pos < len)
+                out[pos] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+};
+
+struct LogReader {
+    const uint8_t *data;
+    size_t len;
+    size_t pos = 0;
+
+    uint64_t get(int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++, pos++) {
+            if (pos < len)
+                value |= uint64_t(data[pos]) << (8 * i);
+        }
+        return value;
+    }
+    bool ok() const { return pos <= len; }
+};
+} // namespace
+
+size_t encodeBattleLog(const BattleLog &log, uint8_t *out, size_t len)
+{
+    LogWriter writer{out, len};
+    writer.put('B', 1);
+    writer.put('L', 1);
+    writer.put(1, 1);
+    writer.put(log.rng[0], 8);
+    writer.put(log.rng[1], 8);
+    writer.put(log.round, 2);
+    for (const BattleTeam &team : log.teams) {
+        int count = 32 - __builtin_clz(team.alive | 1);  // Teams enter with units 0..n-1 alive
+        writer.put(team.alive ? count : 0, 1);
+        writer.put(team.dodges, 1);
+        for (int i = 0; team.alive && i < count; i++) {
+            writer.put(static_cast<uint16_t>(team.health[i]), 2);
+            writer.put(static_cast<uint16_t>(team.damage[i]), 2);
+        }
+    }
+    writer.put(log.eventCount, 2);
+    writer.put(log.truncated, 1);
+    for (int i = 0; i < log.eventCount; i++)
+        writer.put(log.events[i], 1);
+    return writer.pos <= len ? writer.pos : 0;
+}
+
+bool decodeBattleLog(const uint8_t *data, size_t len, BattleLog &log)
+{
+    LogReader reader{data, len};
+    log = {};
+    if (reader.get(1) != 'B' || reader.get(1) != 'L' || reader.get(1) != 1)
+        return false;
+    log.rng[0] = reader.get(8);
+    log.rng[1] = reader.get(8);
+    log.round = reader.get(2);
+    for (BattleTeam &team : log.teams) {
+        int count = reader.get(1);
+        if (count > BATTLE_MAX_UNITS)
+            return false;
+        team.dodges = reader.get(1);
+        for (int i = 0; i < count; i++) {
+            team.health[i] = static_cast<int16_t>(reader.get(2));
+            team.damage[i] = static_cast<int16_t>(reader.get(2));
+            team.alive |= 1u << i;
+        }
+    }
+    log.eventCount = reader.get(2);
+    log.truncated = reader.get(1);
+    if (log.eventCount > BATTLE_LOG_MAX_EVENTS)
+        return false;
+    for (int i = 0; i < log.eventCount; i++)
+        log.events[i] = reader.get(1);
+    return reader.ok();
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// AutoChess rules: units, synergies and the battle kernel. Nothing here
+// depends on the firmware, so host tools build it as is.
+
+enum class UnitRace : uint8_t { Human, Elf, Orc };
+enum class UnitClass : uint8_t { Warrior, Ranger, Mage, Assassin };
+
+// Fixed stats of a unit type, see UNIT_TEMPLATES
+struct AutoChessUnitTemplate {
+    const char *name;
+    uint8_t cost;       // 1-5 gold
+    int16_t health;
+    int16_t damage;
+    int16_t mana;
+    UnitRace race;
+    UnitClass unitClass;
+};
+
+// A unit owned by a player; everything that never changes comes from its template
+struct AutoChessUnit {
+    uint8_t templateId;  // Index into UNIT_TEMPLATES
+    uint8_t stars;       // 1-3
+    int16_t health;
+    int16_t mana;
+};
+
+// Board synergies, in the order the battle report lists them
+enum class Synergy : uint8_t { Warriors, Trolls, Elves, Knights, Mages };
+static constexpr size_t SYNERGY_COUNT = static_cast<size_t>(Synergy::Mages) + 1;
+
+// Units on a board per synergy and which synergies are active. Every change
+// to a board goes through add/remove, so reading is O(1).
+struct AutoChessSynergies {
+    uint8_t counts[SYNERGY_COUNT] = {};
+    uint8_t active = 0;  // Bit per Synergy that reached its threshold
+
+    void add(const AutoChessUnitTemplate &unit) { update(unit, 1); }
+    void remove(const AutoChessUnitTemplate &unit) { update(unit, -1); }
+    bool has(Synergy synergy) const { return active & (1u << static_cast<int>(synergy)); }
+
+  private:
+    void update(const AutoChessUnitTemplate &unit, int delta);
+};
+
+// Predefined units for the shop
+extern const AutoChessUnitTemplate UNIT_TEMPLATES[];
+static const int UNIT_TEMPLATES_COUNT = 10;  // Number of different unit types
+
+// Synergy thresholds and effects
+static const int WARRIOR_SYNERGY_THRESHOLD = 3;
+static const float WARRIOR_DAMAGE_REDUCTION = 0.2f; // 20% damage reduction for 3+ warriors
+static const int TROLL_SYNERGY_THRESHOLD = 2;
+static const float TROLL_ATTACK_SPEED_BONUS = 0.3f; // 30% attack speed bonus for 2+ trolls
+static const int ELF_SYNERGY_THRESHOLD = 3;
+static const float ELF_DODGE_CHANCE = 0.25f; // 25% dodge chance for 3+ elves
+static const int KNIGHT_SYNERGY_THRESHOLD = 2;
+static const float KNIGHT_DAMAGE_REDUCTION = 0.15f; // 15% damage reduction for 2+ humans
+static const int MAGE_SYNERGY_THRESHOLD = 2;
+static const float MAGE_DAMAGE_BOOST = 0.25f; // 25% damage boost for 2+ mages
+
+// Most units a board holds (3x3)
+static const int BATTLE_MAX_UNITS = 9;
+
+// Battles stop after this many rounds even if both sides still stand, so
+// teams that cannot hurt each other still finish
+static const int BATTLE_MAX_ROUNDS = 1000;
+
+// One side of an AutoChess battle, in board order. Synergies are already
+// folded into damage, so the fight itself is integer only.
+struct BattleTeam {
+    int16_t health[BATTLE_MAX_UNITS];
+    int16_t damage[BATTLE_MAX_UNITS];  // Per hit against the other team
+    uint16_t alive;                    // Bit per unit still standing
+    bool dodges;                       // Attacks on this team may miss
+};
+
+struct BattleResult {
+    bool team1Won;
+    int healthLost[2];
+    uint16_t rounds;
+};
+
+// One byte per attack: the attacking unit, its side and what happened. The
+// target is always the first living unit of the other side.
+enum class BattleEvent : uint8_t { Hit, Dodge, Kill };
+static inline uint8_t packBattleEvent(BattleEvent event, int side, int unit)
+{
+    return static_cast<uint8_t>(static_cast<uint8_t>(event) << 5 | side << 4 | unit);
+}
+static inline BattleEvent battleEventKind(uint8_t record) { return static_cast<BattleEvent>(record >> 5); }
+static inline int battleEventSide(uint8_t record) { return (record >> 4) & 1; }
+static inline int battleEventUnit(uint8_t record) { return record & 0xF; }
+
+// Everything needed to replay a battle: both teams as they entered it, the
+// dodge RNG state and the attacks that followed. Long battles keep their
+// first BATTLE_LOG_MAX_EVENTS attacks so an encoded log fits one packet.
+static const int BATTLE_LOG_MAX_EVENTS = 128;
+static const size_t BATTLE_LOG_MAX_ENCODED = 228;
+
+struct BattleLog {
+    uint32_t players[2];  // Node numbers, not encoded
+    uint16_t round;
+    uint64_t rng[2];      // GamesRandom::save() before the first attack
+    BattleTeam teams[2];
+    uint16_t eventCount;
+    bool truncated;
+    uint8_t events[BATTLE_LOG_MAX_EVENTS];
+
+    void record(uint8_t event)
+    {
+        if (eventCount < BATTLE_LOG_MAX_EVENTS)
+            events[eventCount++] = event;
+        else
+            truncated = true;
+    }
+};
+
+// Little endian: "BL" 1, rng (2 x 8), round (2), per team unit count, dodges
+// and health/damage pairs (2 + 2 each), event count (2), truncated, events.
+size_t encodeBattleLog(const BattleLog &log, uint8_t *out, size_t len);
+bool decodeBattleLog(const uint8_t *data, size_t len, BattleLog &log);
+
+// Asked once per attack on a team that dodges; true means the attack missed
+typedef bool (*BattleDodge)(void *context);
+
+// The elf synergy's dodge, drawn from the GamesRandom passed as context
+bool elfDodge(void *rng);
+
+// Board units as a battle team, with its own and the defender's synergies
+// applied to damage
+void fillBattleTeam(BattleTeam &team, const AutoChessUnit *units, size_t count, const AutoChessSynergies &own,
+                    const AutoChessSynergies &defender);
+
+// Every round each living unit of team 1, then of team 2, hits the first
+// living unit of the other side. Teams are updated in place. Attacks are
+// appended to log unless it is null.
+BattleResult runBattle(BattleTeam &team1, BattleTeam &team2, BattleDodge dodge, void *context,
+                       BattleLog *log = nullptr);
@@ -0,0 +1,275 @@
+#include "AutoChessBattleBatch.h"
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Lane-wise 16-bit operations. Comparisons return all ones or all zeros per
+// lane, so results combine with and/andNot like masks.
+namespace
+{
+#if defined(__AVX2__)
+struct Lanes {
+    typedef __m256i Vec;
+    static const int WIDTH = 16;
+    static Vec load(const void *p) { return _mm256_load_si256(static_cast<const Vec *>(p)); }
+    static void store(void *p, Vec v) { _mm256_store_si256(static_cast<Vec *>(p), v); }
+    static Vec set(int16_t x) { return _mm256_set1_epi16(x); }
+    static Vec andOf(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    static Vec andNot(Vec a, Vec b) { return _mm256_andnot_si256(a, b); }  // ~a & b
+    static Vec orOf(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_epi16(a, b); }
+    static Vec equal(Vec a, Vec b) { return _mm256_cmpeq_epi16(a, b); }
+    static Vec greater(Vec a, Vec b) { return _mm256_cmpgt_epi16(a, b); }
+    static bool any(Vec v) { return !_mm256_testz_si256(v, v); }
+};
+const char *const KERNEL_NAME = "avx2";
+#elif defined(__SSE2__)
+struct Lanes {
+    typedef __m128i Vec;
+    static const int WIDTH = 8;
+    static Vec load(const void *p) { return _mm_load_si128(static_cast<const Vec *>(p)); }
+    static void store(void *p, Vec v) { _mm_store_si128(static_cast<Vec *>(p), v); }
+    static Vec set(int16_t x) { return _mm_set1_epi16(x); }
+    static Vec andOf(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static Vec andNot(Vec a, Vec b) { return _mm_andnot_si128(a, b); }
+    static Vec orOf(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_epi16(a, b); }
+    static Vec equal(Vec a, Vec b) { return _mm_cmpeq_epi16(a, b); }
+    static Vec greater(Vec a, Vec b) { return _mm_cmpgt_epi16(a, b); }
+    static bool any(Vec v) { return _mm_movemask_epi8(v) != 0; }
+};
+const char *const KERNEL_NAME = "sse2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+struct Lanes {
+    typedef uint16x8_t Vec;
+    static const int WIDTH = 8;
+    static Vec load(const void *p) { return vld1q_u16(static_cast<const uint16_t *>(p)); }
+    static void store(void *p, Vec v) { vst1q_u16(static_cast<uint16_t *>(p), v); }
+    static Vec set(int16_t x) { return vdupq_n_u16(static_cast<uint16_t>(x)); }
+    static Vec andOf(Vec a, Vec b) { return vandq_u16(a, b); }
+    static Vec andNot(Vec a, Vec b) { return vbicq_u16(b, a); }
+    static Vec orOf(Vec a, Vec b) { return vorrq_u16(a, b); }
+    static Vec sub(Vec a, Vec b) { return vsubq_u16(a, b); }
+    static Vec equal(Vec a, Vec b) { return vceqq_u16(a, b); }
+    static Vec greater(Vec a, Vec b) { return vcgtq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)); }
+    static bool any(Vec v) { return vmaxvq_u16(v) != 0; }
+};
+const char *const KERNEL_NAME = "neon";
+#else
+struct Lanes {
+    typedef int16_t Vec;
+    static const int WIDTH = 1;
+    static Vec load(const void *p) { return *static_cast<const int16_t *>(p); }
+    static void store(void *p, Vec v) { *static_cast<int16_t *>(p) = v; }
+    static Vec set(int16_t x) { return x; }
+    static Vec andOf(Vec a, Vec b) { return a & b; }
+    static Vec andNot(Vec a, Vec b) { return ~a & b; }
+    static Vec orOf(Vec a, Vec b) { return a | b; }
+    static Vec sub(Vec a, Vec b) { return static_cast<int16_t>(a - b); }
+    static Vec equal(Vec a, Vec b) { return a == b ? -1 : 0; }
+    static Vec greater(Vec a, Vec b) { return a > b ? -1 : 0; }
+    static bool any(Vec v) { return v != 0; }
+};
+const char *const KERNEL_NAME = "scalar";
+#endif
+typedef Lanes::Vec Vec;
+
+static_assert(BATTLE_BATCH_LANES % Lanes::WIDTH == 0, "Batches are whole vectors");
+
+// elfDodge as a bound on the raw draw: unit() is (next() >> 8) / 2^24 exactly,
+// so it is below ELF_DODGE_CHANCE exactly when next() >> 8 is below this
+const float DODGE_SCALED = ELF_DODGE_CHANCE * 16777216.0f;
+const uint32_t DODGE_BELOW = uint32_t(DODGE_SCALED) + (float(uint32_t(DODGE_SCALED)) < DODGE_SCALED);
+
+// Bit i of a lane mask, for turning a mask built lane by lane into a vector
+alignas(32) const int16_t LANE_BITS[16] = {1 << 0, 1 << 1, 1 << 2,  1 << 3,  1 << 4,  1 << 5,  1 << 6,  1 << 7,
+                                           1 << 8, 1 << 9, 1 << 10, 1 << 11, 1 << 12, 1 << 13, 1 << 14, INT16_MIN};
+
+// Lane i all ones when bit i of bits is set
+Vec fromBits(uint32_t bits)
+{
+    Vec lanes = Lanes::load(LANE_BITS);
+    return Lanes::equal(Lanes::andOf(Lanes::set(static_cast<int16_t>(bits)), lanes), lanes);
+}
+
+Vec select(Vec mask, Vec a, Vec b)
+{
+    return Lanes::orOf(Lanes::andOf(mask, a), Lanes::andNot(mask, b));
+}
+
+// A run of Lanes::WIDTH lanes fought together. Units stand in slots
+// 0..count-1 and only the front one, the lowest still standing, is ever hit,
+// so a side is just its front slot and the front unit's health. Both stay in
+// registers; the health table is only read when a front unit falls.
+struct Chunk {
+    BattleBatch &batch;
+    int first;
+    int slots[2] = {};     // Most units a side fields in any lane
+    bool dodges[2] = {};   // Side dodges in any lane
+    Vec count[2], front[2], frontHealth[2];
+
+    Chunk(BattleBatch &batch, int first) : batch(batch), first(first)
+    {
+        for (int side = 0; side < 2; side++) {
+            for (int i = 0; i < Lanes::WIDTH; i++) {
+                int units = batch.count[side][first + i];
+                slots[side] = units > slots[side] ? units : slots[side];
+                dodges[side] |= units && batch.dodges[side][first + i];
+            }
+            count[side] = Lanes::load(&batch.count[side][first]);
+            front[side] = Lanes::set(0);
+            frontHealth[side] = Lanes::load(&batch.health[side][0][first]);
+        }
+    }
+
+    Vec standing(int side) const { return Lanes::greater(count[side], front[side]); }
+
+    // One attack by slot `unit` of `side` in every lane where that unit stands
+    // and the battle is on
+    void attack(int side, int unit, Vec active)
+    {
+        int defender = 1 - side;
+        Vec slot = Lanes::set(unit);
+        Vec attacks = Lanes::andNot(Lanes::greater(front[side], slot), Lanes::andOf(Lanes::greater(count[side], slot), active));
+        attacks = Lanes::andOf(attacks, standing(defender));
+        if (!Lanes::any(attacks))
+            return;
+        if (dodges[defender])
+            attacks = Lanes::andNot(drawDodges(defender, attacks), attacks);
+
+        Vec health = Lanes::sub(frontHealth[defender], Lanes::andOf(Lanes::load(&batch.damage[side][unit][first]), attacks));
+        Vec died = Lanes::andOf(Lanes::greater(Lanes::set(1), health), attacks);
+        frontHealth[defender] = health;
+        if (Lanes::any(died))
+            fall(defender, died);
+    }
+
+    // Lanes where the front unit of `side` died move on to the next slot, whose
+    // unit has not been hit yet
+    void fall(int side, Vec died)
+    {
+        front[side] = Lanes::sub(front[side], died);  // Died lanes are -1
+        Vec next = Lanes::set(0);
+        for (int unit = 1; unit < slots[side]; unit++) {
+            Vec here = Lanes::equal(front[side], Lanes::set(unit));
+            next = select(here, Lanes::load(&batch.health[side][unit][first]), next);
+        }
+        frontHealth[side] = select(died, next, frontHealth[side]);
+    }
+
+    // Lanes among attacks that dodge. Each lane draws from its own stream, at
+    // the same point runBattle would, without branching on the lane.
+    Vec drawDodges(int defender, Vec attacks)
+    {
+        alignas(32) int16_t lanes[Lanes::WIDTH];
+        Lanes::store(lanes, Lanes::andOf(attacks, Lanes::load(&batch.dodges[defender][first])));
+        uint32_t dodged = 0;
+        for (int i = 0; i < Lanes::WIDTH; i++) {
+            uint64_t &state = batch.rngState[first + i];
+            uint64_t old = state;
+            bool draw = lanes[i] != 0;
+            bool dodge = (GamesRandom::output(old) >> 8) < DODGE_BELOW;
+            state = draw ? old * GamesRandom::MULTIPLIER + batch.rngIncrement[first + i] : old;
+            dodged |= uint32_t(draw & dodge) << i;
+        }
+        return fromBits(dodged);
+    }
+
+    void finish(int16_t fronts[2][BATTLE_BATCH_LANES], int16_t frontHealths[2][BATTLE_BATCH_LANES])
+    {
+        for (int side = 0; side < 2; side++) {
+            Lanes::store(&fronts[side][first], front[side]);
+            Lanes::store(&frontHealths[side][first], frontHealth[side]);
+        }
+    }
+};
+} // namespace
+
+void BattleBatch::clear()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+// Standing units are packed into slots 0..count-1 in their order, which keeps
+// the order they attack and fall in and so every dodge draw
+void BattleBatch::setLane(int lane, const BattleTeam &team1, const BattleTeam &team2, GamesRandom *random)
+{
+    const BattleTeam *teams[2] = {&team1, &team2};
+    for (int side = 0; side < 2; side++) {
+        int units = 0;
+        for (uint16_t alive = teams[side]->alive; alive; alive &= alive - 1) {
+            int i = __builtin_ctz(alive);
+            health[side][units][lane] = teams[side]->health[i];
+            damage[side][units][lane] = teams[side]->damage[i];
+            units++;
+        }
+        for (int i = units; i < BATTLE_MAX_UNITS; i++) {
+            health[side][i][lane] = 0;
+            damage[side][i][lane] = 0;
+        }
+        count[side][lane] = units;
+        dodges[side][lane] = teams[side]->dodges ? -1 : 0;
+    }
+    uint64_t saved[2];
+    random->save(saved);
+    rngState[lane] = saved[0];
+    rngIncrement[lane] = saved[1];
+    rng[lane] = random;
+}
+
+void runBattleBatch(BattleBatch &batch, BattleResult results[BATTLE_BATCH_LANES])
+{
+    alignas(32) int16_t rounds[BATTLE_BATCH_LANES];
+    alignas(32) int16_t fronts[2][BATTLE_BATCH_LANES];
+    alignas(32) int16_t frontHealths[2][BATTLE_BATCH_LANES];
+    Vec zero = Lanes::set(0);
+    for (int first = 0; first < BATTLE_BATCH_LANES; first += Lanes::WIDTH) {
+        Chunk chunk(batch, first);
+        Vec roundCount = zero;
+        for (int round = 0; round < BATTLE_MAX_ROUNDS; round++) {
+            Vec active = Lanes::andOf(chunk.standing(0), chunk.standing(1));
+            if (!Lanes::any(active))
+                break;
+            roundCount = Lanes::sub(roundCount, active);  // Active lanes are -1
+            for (int side = 0; side < 2; side++) {
+                for (int unit = 0; unit < chunk.slots[side]; unit++)
+                    chunk.attack(side, unit, active);
+            }
+        }
+        chunk.finish(fronts, frontHealths);
+        Lanes::store(&rounds[first], roundCount);
+    }
+
+    for (int lane = 0; lane < BATTLE_BATCH_LANES; lane++) {
+        int start[2] = {}, left[2] = {};
+        bool alive[2];
+        for (int side = 0; side < 2; side++) {
+            int front = fronts[side][lane];
+            for (int i = 0; i < batch.count[side][lane]; i++) {
+                start[side] += batch.health[side][i][lane];
+                if (i > front)
+                    left[side] += batch.health[side][i][lane];
+            }
+            alive[side] = front < batch.count[side][lane];
+            if (alive[side])
+                left[side] += frontHealths[side][lane];
+        }
+        results[lane].healthLost[0] = start[0] - left[0];
+        results[lane].healthLost[1] = start[1] - left[1];
+        results[lane].rounds = rounds[lane];
+        results[lane].team1Won = alive[0] && (!alive[1] || left[0] >= left[1]);
+        if (batch.rng[lane]) {
+            uint64_t state[2] = {batch.rngState[lane], batch.rngIncrement[lane]};
+            batch.rng[lane]->restore(state);
+        }
+    }
+}
+
+const char *battleBatchKernel()
+{
+    return KERNEL_NAME;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "AutoChessBattle.h"
+#include "GamesRandom.h"
+
+// Up to this many independent battles run side by side in one batch
+static const int BATTLE_BATCH_LANES = 16;
+
+// Battles laid out structure-of-arrays, lane by lane, so a health update is
+// one vector operation across lanes. Each lane's random stream is held the
+// same way, so elf dodges are drawn without a call per attack. Fill with
+// setLane; unused lanes stay empty and finish at once. The tables hold the
+// starting teams and are not changed by runBattleBatch.
+struct BattleBatch {
+    alignas(32) int16_t health[2][BATTLE_MAX_UNITS][BATTLE_BATCH_LANES];
+    alignas(32) int16_t damage[2][BATTLE_MAX_UNITS][BATTLE_BATCH_LANES];
+    alignas(32) int16_t count[2][BATTLE_BATCH_LANES];   // Units in slots 0..count-1
+    alignas(32) int16_t dodges[2][BATTLE_BATCH_LANES];  // All ones where the side dodges
+    alignas(32) uint64_t rngState[BATTLE_BATCH_LANES];
+    alignas(32) uint64_t rngIncrement[BATTLE_BATCH_LANES];
+    GamesRandom *rng[BATTLE_BATCH_LANES];              // Gets the advanced stream back
+
+    void clear();
+    void setLane(int lane, const BattleTeam &team1, const BattleTeam &team2, GamesRandom *rng);
+};
+
+// Runs every lane to the end with elfDodge as the dodge rule. Each lane gives
+// the same result and leaves its GamesRandom in the same state as runBattle
+// would, bit for bit. The health arithmetic is vectorized (AVX2, SSE2 or NEON
+// when built for them, plain C++ otherwise).
+void runBattleBatch(BattleBatch &batch, BattleResult results[BATTLE_BATCH_LANES]);
+
+// Which implementation runBattleBatch was built with
+const char *battleBatchKernel();
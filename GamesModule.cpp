@@ -2,10 +2,16 @@
 #include "MeshService.h"
 #include "configuration.h"
 #include "main.h"
+#include <charconv>
 #include <cstring>
-#include <sstream>
-#include <ctime>
-#include <random>
+#include <algorithm>
+
+#if ARCH_PORTDUINO
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // Word list for Hangman
 const char* const GamesModule::HANGMAN_WORDS[] = {
@@ -36,32 +42,130 @@ const char* const GamesModule::HANGMAN_WORDS[] = {
     "TEMPLE", "MONASTERY", "CATHEDRAL", "MOSQUE", "PAGODA"
 };
 
-// Predefined units for Auto Chess
-const AutoChessUnit GamesModule::UNIT_TEMPLATES[] = {
-    {"Knight", 1, 3, 100, 15, 50, "Human", "Warrior"},
-    {"Archer", 1, 2, 70, 20, 40, "Elf", "Ranger"},
-    {"Mage", 1, 4, 60, 25, 80, "Human", "Mage"},
-    {"Orc Warrior", 1, 3, 120, 18, 30, "Orc", "Warrior"},
-    {"Druid", 1, 3, 80, 15, 60, "Elf", "Mage"},
-    {"Assassin", 1, 4, 65, 30, 50, "Human", "Assassin"},
-    {"Troll", 1, 2, 90, 12, 40, "Orc", "Warrior"},
-    {"Priest", 1, 3, 75, 10, 70, "Human", "Mage"},
-    {"Ranger", 1, 2, 70, 18, 45, "Elf", "Ranger"},
-    {"Berserker", 1, 4, 110, 25, 35, "Orc", "Warrior"}
+const int GamesModule::HANGMAN_WORDS_COUNT = sizeof(HANGMAN_WORDS) / sizeof(HANGMAN_WORDS[0]);
+
+// Hangman difficulty: how many distinct letters of a word lie outside the twelve
+// most common English ones, 0 (easy) to 2 (hard). bin/build-hangman-dict.py
+// buckets the external dictionary by the same rule.
+constexpr std::string_view HANGMAN_LEVELS[] = {"easy", "medium", "hard"};
+
+static int hangmanDifficulty(std::string_view word)
+{
+    uint32_t rare = 0;
+    for (char c : word) {
+        if (c >= 'A' && c <= 'Z' && std::string_view("ETAOINSHRDLU").find(c) == std::string_view::npos)
+            rare |= 1u << (c - 'A');
+    }
+    return std::min(__builtin_popcount(rare), 2);
+}
+
+const char *const GamesModule::UNIT_RACE_NAMES[] = {"Human", "Elf", "Orc"};
+const char *const GamesModule::UNIT_CLASS_NAMES[] = {"Warrior", "Ranger", "Mage", "Assassin"};
+
+// Every Tic Tac Toe position has an index in base 3: square i adds 3^i for an X
+// and 2 * 3^i for an O, so placing a mark always moves to a higher index.
+constexpr int TTT_POSITIONS = 19683; // 3^9
+constexpr uint8_t TTT_NO_MOVE = 0xF;
+
+constexpr int ticTacToeIndex(uint16_t xMask, uint16_t oMask)
+{
+    int index = 0;
+    for (int i = 8; i >= 0; i--)
+        index = index * 3 + ((xMask >> i) & 1) + 2 * ((oMask >> i) & 1);
+    return index;
+}
+
+// Solves the game by negamax over all positions, highest index first so every
+// child is scored before its parent. A side that has lost scores -(empty + 1),
+// which makes the bot prefer quick wins and slow losses. The result is the best
+// square for the side to move, one nibble per position, TTT_NO_MOVE if the
+// position is finished or unreachable.
+constexpr std::array<uint8_t, (TTT_POSITIONS + 1) / 2> buildTicTacToeMoves()
+{
+    std::array<uint8_t, (TTT_POSITIONS + 1) / 2> moves{};
+    std::array<int8_t, TTT_POSITIONS> score{};
+    int pow3[9] = {1, 3, 9, 27, 81, 243, 729, 2187, 6561};
+    int digits[9] = {2, 2, 2, 2, 2, 2, 2, 2, 2};
+
+    for (int index = TTT_POSITIONS - 1; index >= 0; index--) {
+        uint16_t x = 0, o = 0;
+        for (int i = 0; i < 9; i++) {
+            if (digits[i] == 1)
+                x |= 1u << i;
+            else if (digits[i] == 2)
+                o |= 1u << i;
+        }
+        int xs = __builtin_popcount(x), os = __builtin_popcount(o);
+        int empty = 9 - xs - os;
+        uint8_t best = TTT_NO_MOVE;
+
+        if (xs == os || xs == os + 1) {
+            if (hasTicTacToeLine(x) || hasTicTacToeLine(o)) {
+                score[index] = -(empty + 1);
+            } else if (empty > 0) {
+                int mark = (xs == os) ? 1 : 2;
+                int bestScore = -128;
+                for (int sq = 0; sq < 9; sq++) {
+                    if (digits[sq] == 0 && -score[index + mark * pow3[sq]] > bestScore) {
+                        bestScore = -score[index + mark * pow3[sq]];
+                        best = sq;
+                    }
+                }
+                score[index] = bestScore;
+            }
+        }
+        moves[index / 2] |= best << (index % 2 * 4);
+
+        // Step the base 3 digits down to index - 1
+        for (int i = 0; i < 9; i++) {
+            if (digits[i] > 0) {
+                digits[i]--;
+                break;
+            }
+            digits[i] = 2;
+        }
+    }
+    return moves;
+}
+
+constexpr auto TTT_MOVES = buildTicTacToeMoves();
+static_assert((TTT_MOVES[ticTacToeIndex(1, 0) / 2] >> 4) == 4, "Only the centre holds against a corner opening");
+
+// Bot strength as the chance of playing a random square instead of the best one
+struct TicTacToeBotLevel {
+    std::string_view name;
+    uint8_t randomPercent;
 };
+constexpr TicTacToeBotLevel TTT_BOT_LEVELS[] = {{"easy", 60}, {"medium", 25}, {"hard", 0}};
+constexpr size_t TTT_DEFAULT_BOT_LEVEL = 1;
 
 // Add these constants at the top with other constants
 const int BATTLE_INTERVAL_SECONDS = 30;
-const int WARRIOR_SYNERGY_THRESHOLD = 3;
-const float WARRIOR_DAMAGE_REDUCTION = 0.2f; // 20% damage reduction for 3+ warriors
-const int TROLL_SYNERGY_THRESHOLD = 2;
-const float TROLL_ATTACK_SPEED_BONUS = 0.3f; // 30% attack speed bonus for 2+ trolls
-const int ELF_SYNERGY_THRESHOLD = 3;
-const float ELF_DODGE_CHANCE = 0.25f; // 25% dodge chance for 3+ elves
-const int KNIGHT_SYNERGY_THRESHOLD = 2;
-const float KNIGHT_DAMAGE_REDUCTION = 0.15f; // 15% damage reduction for 2+ humans
-const int MAGE_SYNERGY_THRESHOLD = 2;
-const float MAGE_DAMAGE_BOOST = 0.25f; // 25% damage boost for 2+ mages
+
+// Battle report lines, indexed by Synergy
+const char *const SYNERGY_TEXT[SYNERGY_COUNT] = {"Warriors (-20% dmg)\n", "Trolls (+30% speed)\n", "Elves (25% dodge)\n",
+                                                 "Knights (-15% dmg)\n", "Mages (+25% dmg)"};
+
+GamesModule::GamesModule() : SinglePortModule("games", meshtastic_PortNum_TEXT_MESSAGE_APP), concurrency::OSThread("Games")
+{
+    seedSource.seed((uint64_t(random(INT32_MAX)) << 32) ^ uint64_t(random(INT32_MAX)) ^ millis(), 0);
+
+#if ARCH_PORTDUINO
+    if (hangmanDictionary.open(HANGMAN_DICTIONARY_PATH))
+        LOG_INFO("Hangman dictionary %s: %u words\n", HANGMAN_DICTIONARY_PATH, (unsigned)hangmanDictionary.count(-1));
+#endif
+}
+
+// Every game has its own seed and stream. The seed is logged so a game can be
+// replayed by seeding GamesRandom the same way.
+void GamesModule::seedGame(GamesRandom &rng, GameKind kind, uint32_t gameId)
+{
+    uint64_t seed = (uint64_t(seedSource.next()) << 32) | seedSource.next();
+    uint64_t stream = (uint64_t(kind) << 32) | gameId;
+    rng.seed(seed, stream);
+    LOG_DEBUG("Games: game %u/%08x seed %08x%08x\n", unsigned(kind), (unsigned)gameId, (unsigned)(seed >> 32),
+              (unsigned)seed);
+}
 
 meshtastic_MeshPacket *GamesModule::allocReply()
 {
@@ -70,288 +174,1283 @@ meshtastic_MeshPacket *GamesModule::allocReply()
     return reply;
 }
 
+// Command dispatch table. Single character verbs (board positions, letters and
+// RPS choices) are looked up under "?" and passed through CommandArgs::letter.
+constexpr GameCommand GamesModule::COMMANDS[] = {
+    {GameKind::None, "help", ArgSchema::None, nullptr, &GamesModule::cmdHelp},
+    {GameKind::None, "games", ArgSchema::None, nullptr, &GamesModule::cmdHelp},
+    {GameKind::None, "gamestats", ArgSchema::None, nullptr, &GamesModule::cmdStats},
+
+    {GameKind::TicTacToe, "new", ArgSchema::None, nullptr, &GamesModule::cmdTicTacToeNew},
+    {GameKind::TicTacToe, "join", ArgSchema::OptInt, "Usage: ttt join [max_hops]", &GamesModule::cmdTicTacToeJoin},
+    {GameKind::TicTacToe, "board", ArgSchema::None, nullptr, &GamesModule::cmdTicTacToeBoard},
+    {GameKind::TicTacToe, "bot", ArgSchema::OptWord, nullptr, &GamesModule::cmdTicTacToeBot},
+    {GameKind::TicTacToe, "?", ArgSchema::Char, nullptr, &GamesModule::cmdTicTacToeMove},
+
+    {GameKind::Hangman, "", ArgSchema::None, nullptr, &GamesModule::cmdHangmanNew},
+    {GameKind::Hangman, "new", ArgSchema::OptWord, nullptr, &GamesModule::cmdHangmanNew},
+    {GameKind::Hangman, "state", ArgSchema::None, nullptr, &GamesModule::cmdHangmanState},
+    {GameKind::Hangman, "?", ArgSchema::Char, nullptr, &GamesModule::cmdHangmanGuess},
+
+    {GameKind::RPS, "new", ArgSchema::None, nullptr, &GamesModule::cmdRPSNew},
+    {GameKind::RPS, "bot", ArgSchema::None, nullptr, &GamesModule::cmdRPSBot},
+    {GameKind::RPS, "join", ArgSchema::OptInt, "Usage: rps join [max_hops]", &GamesModule::cmdRPSJoin},
+    {GameKind::RPS, "?", ArgSchema::Char, nullptr, &GamesModule::cmdRPSChoice},
+
+    {GameKind::AutoChess, "new", ArgSchema::None, nullptr, &GamesModule::cmdAutoChessNew},
+    {GameKind::AutoChess, "status", ArgSchema::None, nullptr, &GamesModule::cmdAutoChessStatus},
+    {GameKind::AutoChess, "join", ArgSchema::OptInt, "Invalid game ID. Usage: ac join [game_id]",
+     &GamesModule::cmdAutoChessJoin},
+    {GameKind::AutoChess, "state", ArgSchema::None, nullptr, &GamesModule::cmdAutoChessState},
+    {GameKind::AutoChess, "buy", ArgSchema::Int, "Invalid unit index. Usage: ac buy <unit_index>",
+     &GamesModule::cmdAutoChessBuy},
+    {GameKind::AutoChess, "sell", ArgSchema::Int, "Invalid unit index. Usage: ac sell <unit_index>",
+     &GamesModule::cmdAutoChessSell},
+    {GameKind::AutoChess, "place", ArgSchema::IntPair, "Invalid indices. Usage: ac place <bench_index> <board_index>",
+     &GamesModule::cmdAutoChessPlace},
+    {GameKind::AutoChess, "log", ArgSchema::OptInt, "Invalid round. Usage: ac log [round]",
+     &GamesModule::cmdAutoChessLog},
+};
+
+constexpr size_t GamesModule::COMMANDS_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+// FNV-1a over the game and verb. The seed was picked so that the table has no
+// collisions in COMMAND_SLOT_COUNT slots; commandHashIsPerfect() enforces this.
+constexpr uint32_t GamesModule::commandHash(GameKind game, std::string_view verb)
+{
+    uint32_t hash = (COMMAND_HASH_SEED ^ static_cast<uint8_t>(game)) * 16777619u;
+    for (char c : verb) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr bool GamesModule::commandHashIsPerfect()
+{
+    for (size_t i = 0; i < COMMANDS_COUNT; i++) {
+        for (size_t j = i + 1; j < COMMANDS_COUNT; j++) {
+            if (commandHash(COMMANDS[i].game, COMMANDS[i].verb) % COMMAND_SLOT_COUNT ==
+                commandHash(COMMANDS[j].game, COMMANDS[j].verb) % COMMAND_SLOT_COUNT)
+                return false;
+        }
+    }
+    return true;
+}
+
+constexpr std::array<int8_t, GamesModule::COMMAND_SLOT_COUNT> GamesModule::buildCommandSlots()
+{
+    std::array<int8_t, COMMAND_SLOT_COUNT> slots{};
+    for (auto &slot : slots)
+        slot = -1;
+    for (size_t i = 0; i < COMMANDS_COUNT; i++)
+        slots[commandHash(COMMANDS[i].game, COMMANDS[i].verb) % COMMAND_SLOT_COUNT] = static_cast<int8_t>(i);
+    return slots;
+}
+
+constexpr std::array<int8_t, GamesModule::COMMAND_SLOT_COUNT> GamesModule::COMMAND_SLOTS = buildCommandSlots();
+
+const GameCommand *GamesModule::findCommand(GameKind game, std::string_view verb)
+{
+    static_assert(commandHashIsPerfect(), "Command hash collides, change the seed or COMMAND_SLOT_COUNT");
+    int8_t index = COMMAND_SLOTS[commandHash(game, verb) % COMMAND_SLOT_COUNT];
+    if (index < 0)
+        return nullptr;
+    const GameCommand &command = COMMANDS[index];
+    return (command.game == game && command.verb == verb) ? &command : nullptr;
+}
+
+// Split off the next space separated token, leaving the remainder in text
+static std::string_view nextToken(std::string_view &text)
+{
+    size_t start = text.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        text = {};
+        return {};
+    }
+    text.remove_prefix(start);
+    size_t end = text.find(' ');
+    std::string_view token = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end);
+    return token;
+}
+
+static GameKind gameFromToken(std::string_view token)
+{
+    if (token == "t" || token == "ttt")
+        return GameKind::TicTacToe;
+    if (token == "h" || token == "hangman")
+        return GameKind::Hangman;
+    if (token == "r" || token == "rps")
+        return GameKind::RPS;
+    if (token == "ac")
+        return GameKind::AutoChess;
+    return GameKind::None;
+}
+
+bool GamesModule::parseArgs(ArgSchema schema, std::string_view text, CommandArgs &args)
+{
+    if (schema == ArgSchema::OptWord) {
+        args.word = nextToken(text);
+        return true;
+    }
+
+    int count = (schema == ArgSchema::Int || schema == ArgSchema::OptInt) ? 1 : (schema == ArgSchema::IntPair) ? 2 : 0;
+    for (int i = 0; i < count; i++) {
+        std::string_view token = nextToken(text);
+        if (token.empty() && schema == ArgSchema::OptInt)
+            break;
+        auto result = std::from_chars(token.data(), token.data() + token.size(), args.values[i]);
+        if (token.empty() || result.ec != std::errc())
+            return false;
+        args.count++;
+    }
+    return true;
+}
+
+// Every command starts with a game word or module verb of at most
+// MAX_COMMAND_WORD_LEN bytes. After a game word only that prefix has to be
+// inspected; a module verb has to be the whole message.
+bool GamesModule::isGameTraffic(std::string_view payload)
+{
+    if (payload.empty())
+        return false;
+
+    switch (payload[0]) {
+    case 't':
+    case 'h':
+    case 'r':
+    case 'a':
+    case 'g':
+        break;
+    default:
+        return false;
+    }
+
+    size_t len = 1;
+    while (len < payload.size() && payload[len] != ' ') {
+        if (++len > MAX_COMMAND_WORD_LEN)
+            return false;
+    }
+
+    std::string_view word = payload.substr(0, len);
+    if (gameFromToken(word) != GameKind::None)
+        return true;
+
+    // Module verbs take no arguments, so like dispatch only accept them alone
+    std::string_view rest = payload.substr(len);
+    return rest.find_first_not_of(' ') == std::string_view::npos && findCommand(GameKind::None, word) != nullptr;
+}
+
 ProcessMessage GamesModule::handleReceived(const meshtastic_MeshPacket &mp)
 {
-    if (mp.decoded.payload.size == 0)
+    const auto &payload = mp.decoded.payload;
+    return dispatch(mp, std::string_view(reinterpret_cast<const char *>(payload.bytes), payload.size), false);
+}
+
+// The binary port is one of the shared private app ports, so only frames that
+// start with GAMES_BINARY_MAGIC are ours; anything else is left to other modules
+ProcessMessage GamesModule::handleBinaryReceived(const meshtastic_MeshPacket &mp)
+{
+    const auto &payload = mp.decoded.payload;
+    if (payload.size == 0 || payload.bytes[0] != GAMES_BINARY_MAGIC)
         return ProcessMessage::CONTINUE;
+    return dispatch(mp, std::string_view(reinterpret_cast<const char *>(payload.bytes) + 1, payload.size - 1), true);
+}
 
-    // Clean up old games before processing new commands
-    cleanupOldGames();
+ProcessMessage GamesModule::dispatch(const meshtastic_MeshPacket &mp, std::string_view text, bool binary)
+{
+    // Ordinary chat leaves here without touching any game state
+    if (!isGameTraffic(text)) {
+        countRejected(mp, binary);
+        return ProcessMessage::CONTINUE;
+    }
 
-    // Process battles for active games
-    time_t currentTime = time(nullptr);
-    for (auto &game : activeAutoChessGames) {
-        if (game.second.isActive && 
-            currentTime - game.second.wasUpdated >= BATTLE_INTERVAL_SECONDS) {
-            processRound(game.second);
-        }
+    // Parse the payload in place: "<game> <verb> [args]" or a module-wide "<verb>"
+    std::string_view verb = nextToken(text);
+    GameKind game = gameFromToken(verb);
+    if (game != GameKind::None)
+        verb = nextToken(text);
+
+    CommandArgs args = {};
+    if (verb.size() == 1) {
+        args.letter = verb[0];
+        verb = "?";
     }
 
-    // Convert payload to null-terminated string
-    char payload[mp.decoded.payload.size + 1];
-    memcpy(payload, mp.decoded.payload.bytes, mp.decoded.payload.size);
-    payload[mp.decoded.payload.size] = 0;
-
-    // Handle help and games commands
-    if (strcmp(payload, "help") == 0 || strcmp(payload, "games") == 0) {
-        auto reply = allocReply();
-        const char *msg = "Games: TicTacToe(t), Hangman(h), RockPaperScissors(r) & AutoChess(ac)\n"
-                         "t: new/join/board/[1-9]\n"
-                         "h: new/state/[letter]\n"
-                         "r: new/join/bot/[R/P/S]\n"
-                         "ac: new/join/state/buy/sell/place";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    // Verbs without arguments must stand alone: "help me with my radio" is chat
+    const GameCommand *command = findCommand(game, verb);
+    bool standsAlone = text.find_first_not_of(' ') == std::string_view::npos;
+    if (!command || (!standsAlone && (command->schema == ArgSchema::None || command->schema == ArgSchema::Char))) {
+        countRejected(mp, binary);
+        return ProcessMessage::CONTINUE;
+    }
+    stats.commandsHandled++;
+
+    // Answer in the protocol the command arrived in
+    setBinaryClient(mp.from, binary);
+
+    // Expiry and rounds run on the scheduler thread; only refresh the clock for touches
+    updateTick();
+
+    if (!parseArgs(command->schema, text, args)) {
+        sendReply(mp.from, command->usageError);
         return ProcessMessage::STOP;
     }
 
-    // Handle different game commands
-    if (strncmp(payload, "ttt", 3) == 0 || strncmp(payload, "t", 1) == 0) {
-        // Skip "ttt " or "t " and handle the command
-        const char* command = (strncmp(payload, "ttt", 3) == 0) ? payload + 4 : payload + 2;
-        return handleTicTacToeCommand(mp, command) ? ProcessMessage::STOP : ProcessMessage::CONTINUE;
-    }
-    else if (strncmp(payload, "hangman", 7) == 0 || strncmp(payload, "h", 1) == 0) {
-        // Skip "hangman " or "h " and handle the command
-        const char* command = (strncmp(payload, "hangman", 7) == 0) ? payload + 8 : payload + 2;
-        if (strlen(command) == 0) {
-            // If just "hangman" or "h", start a new game
-            startNewHangmanGame(mp.from);
-            auto reply = allocReply();
-            std::string msg = "New Hangman game started!" + getHangmanStateString(activeHangmanGames[mp.from]) + 
-                            "\nGuess: h [letter]";
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return ProcessMessage::STOP;
-        }
-        return handleHangmanCommand(mp, command) ? ProcessMessage::STOP : ProcessMessage::CONTINUE;
+    return (this->*command->handler)(mp, args) ? ProcessMessage::STOP : ProcessMessage::CONTINUE;
+}
+
+void GamesModule::countRejected(const meshtastic_MeshPacket &mp, bool binary)
+{
+    // Only chat on the text port counts; the binary port carries nothing but commands
+    if (binary)
+        return;
+    stats.rejectedMessages++;
+    stats.rejectedBytes += mp.decoded.payload.size;
+}
+
+ReplyWriter &ReplyWriter::operator<<(std::string_view text)
+{
+    size_t n = text.size();
+    if (n > capacity - length) {
+        n = capacity - length;
+        overflow = true;
+    }
+    memcpy(buffer + length, text.data(), n);
+    length += n;
+    return *this;
+}
+
+ReplyWriter &ReplyWriter::operator<<(char c)
+{
+    if (length < capacity)
+        buffer[length++] = c;
+    else
+        overflow = true;
+    return *this;
+}
+
+ReplyWriter &ReplyWriter::varint(uint64_t value)
+{
+    while (value >= 0x80) {
+        *this << static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
     }
-    else if (strncmp(payload, "rps", 3) == 0 || strncmp(payload, "r", 1) == 0) {
-        // Skip "rps " or "r " and handle the command
-        const char* command = (strncmp(payload, "rps", 3) == 0) ? payload + 4 : payload + 2;
-        return handleRPSCommand(mp, command) ? ProcessMessage::STOP : ProcessMessage::CONTINUE;
+    return *this << static_cast<char>(value);
+}
+
+ReplyWriter &ReplyWriter::writeSigned(int64_t value)
+{
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, result.ptr - digits);
+}
+
+ReplyWriter &ReplyWriter::writeUnsigned(uint64_t value)
+{
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, result.ptr - digits);
+}
+
+// Returns the end of the fragment starting at offset: the whole remainder if it
+// fits, else the last line break within capacity, else a hard cut.
+size_t GamesModule::fragmentEnd(const char *text, size_t len, size_t offset, size_t capacity)
+{
+    if (len - offset <= capacity)
+        return len;
+    for (size_t end = offset + capacity; end > offset; end--) {
+        if (text[end] == '\n')
+            return end;
     }
-    else if (strncmp(payload, "ac", 2) == 0) {
-        // Skip "ac " and handle the command
-        const char* command = payload + 3;
-        return handleAutoChessCommand(mp, command) ? ProcessMessage::STOP : ProcessMessage::CONTINUE;
+    return offset + capacity;
+}
+
+void GamesModule::sendReply(uint32_t to, const char *text, size_t len, ReplyPriority priority, GameKind stateOf,
+                            bool supersede)
+{
+    // A newer state update makes any queued one for the same player and game stale.
+    // Deltas only add to what is queued, so they never supersede.
+    if (stateOf != GameKind::None && supersede)
+        supersedeReplies(to, stateOf);
+
+    const size_t capacity = meshtastic_Constants_DATA_PAYLOAD_LEN;
+    if (len <= capacity) {
+        queueReply(to, text, len, priority, stateOf, stateOf != GameKind::None);
+        return;
+    }
+
+    // Count the fragments first so every header can carry the total. The line
+    // break a fragment ends on is replaced by the next fragment's header.
+    const size_t bodyCapacity = capacity - REPLY_FRAGMENT_HEADER_LEN;
+    size_t total = 0;
+    for (size_t offset = 0; offset < len; total++) {
+        size_t end = fragmentEnd(text, len, offset, bodyCapacity);
+        offset = (end < len && text[end] == '\n') ? end + 1 : end;
+    }
+    if (total > MAX_REPLY_FRAGMENTS) {
+        LOG_DEBUG("Games: reply to 0x%x truncated from %u fragments\n", to, (unsigned)total);
+        total = MAX_REPLY_FRAGMENTS;
+        stats.truncatedReplies++;
+    }
+    stats.fragmentedReplies++;
+    stats.fragmentsSent += total;
+
+    char fragment[meshtastic_Constants_DATA_PAYLOAD_LEN];
+    size_t offset = 0;
+    for (size_t i = 0; i < total; i++) {
+        size_t end = fragmentEnd(text, len, offset, bodyCapacity);
+        fragment[0] = '1' + i;
+        fragment[1] = '/';
+        fragment[2] = '0' + total;
+        fragment[3] = '\n';
+        memcpy(fragment + REPLY_FRAGMENT_HEADER_LEN, text + offset, end - offset);
+        queueReply(to, fragment, REPLY_FRAGMENT_HEADER_LEN + (end - offset), priority, stateOf, true);
+        offset = (end < len && text[end] == '\n') ? end + 1 : end;
     }
+}
 
-    return ProcessMessage::CONTINUE;
+// Finds a free TX slot. When the queue is full the newest state update of the
+// least urgent priority below the requested one is evicted, since a later view
+// or resync replaces it; plain replies are never evicted. nullptr if there is none.
+QueuedReply *GamesModule::allocQueuedReply(ReplyPriority priority)
+{
+    QueuedReply *victim = nullptr;
+    for (auto &entry : txQueue) {
+        if (!entry.used)
+            return &entry;
+        if (entry.priority > priority && entry.stateOf != GameKind::None &&
+            (!victim || entry.priority > victim->priority ||
+             (entry.priority == victim->priority && entry.sequence > victim->sequence)))
+            victim = &entry;
+    }
+    stats.droppedReplies++;
+    if (!victim)
+        return nullptr;
+    LOG_DEBUG("Games: TX queue full, dropping reply to 0x%x\n", victim->to);
+    victim->used = false;
+    replyDropped(victim->to, victim->stateOf);
+    return victim;
 }
 
-void GamesModule::cleanupOldGames()
+// True if the queue can take entries more replies and still keep TX_DIRECT_RESERVE
+// slots free. Rounds and timeouts wait for this instead of overflowing the queue.
+bool GamesModule::hasReplyRoom(size_t entries) const
 {
-    time_t currentTime = time(nullptr);
-    std::vector<uint32_t> gamesToRemove;
+    size_t free = 0;
+    for (const auto &entry : txQueue) {
+        if (!entry.used)
+            free++;
+    }
+    return free >= entries + TX_DIRECT_RESERVE;
+}
 
-    // Find games that need to be removed
-    for (const auto &game : activeGames) {
-        time_t timeDiff = currentTime - game.second.wasUpdated;
-        LOG_DEBUG("Game %u: Last updated %ld seconds ago (timeout: %d)\n", 
-                 game.first, timeDiff, GAME_TIMEOUT_SECONDS);
-        if (timeDiff > GAME_TIMEOUT_SECONDS) {
-            gamesToRemove.push_back(game.first);
+void GamesModule::queueReply(uint32_t to, const char *text, size_t len, ReplyPriority priority, GameKind stateOf,
+                             bool sealed)
+{
+    const size_t capacity = meshtastic_Constants_DATA_PAYLOAD_LEN;
+    uint32_t now = millis();
+
+    // A sealed entry drains at once; whatever is still open for this node goes with it, not after
+    if (sealed)
+        sealReplies(to);
+
+    // Append to an open entry for the same node and priority, separated by a blank line
+    if (!sealed) {
+        for (auto &entry : txQueue) {
+            if (!entry.used || entry.sealed || entry.to != to || entry.priority != priority ||
+                entry.binaryPort != isBinaryClient(to))
+                continue;
+            if (now - entry.queuedAt < COALESCE_WINDOW_MS && entry.length + 2 + len <= capacity) {
+                entry.text[entry.length++] = '\n';
+                entry.text[entry.length++] = '\n';
+                memcpy(entry.text + entry.length, text, len);
+                entry.length += len;
+                stats.coalescedReplies++;
+                return;
+            }
+            entry.sealed = true;  // Full, later replies start a new entry
         }
     }
 
-    // Remove the old games
-    for (uint32_t gameId : gamesToRemove) {
-        auto &game = activeGames[gameId];
-        std::string msg = "Game timed out due to inactivity.";
-        
-        // Notify player 1 if they exist
-        if (game.player1 != 0) {
-            auto reply = allocDataPacket();
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = game.player1;
-            service->sendToMesh(reply);
-        }
-        
-        // Notify player 2 if they exist
-        if (game.player2 != 0) {
-            auto reply = allocDataPacket();
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = game.player2;
-            service->sendToMesh(reply);
-        }
-        
-        activeGames.erase(gameId);
+    QueuedReply *entry = allocQueuedReply(priority);
+    if (!entry) {
+        LOG_DEBUG("Games: TX queue full, dropping reply to 0x%x\n", to);
+        replyDropped(to, stateOf);
+        return;
+    }
+    entry->used = true;
+    entry->to = to;
+    entry->queuedAt = now;
+    entry->sequence = txSequence++;
+    entry->priority = priority;
+    entry->stateOf = stateOf;
+    entry->sealed = sealed;
+    entry->binaryPort = isBinaryClient(to);
+    entry->length = len;
+    memcpy(entry->text, text, len);
+    wakeScheduler(sealed ? 0 : COALESCE_WINDOW_MS);
+}
+
+void GamesModule::sealReplies(uint32_t to)
+{
+    for (auto &entry : txQueue) {
+        if (entry.used && entry.to == to)
+            entry.sealed = true;
     }
+}
 
-    // Clean up old Hangman games
-    std::vector<uint32_t> hangmanGamesToRemove;
-    for (const auto &game : activeHangmanGames) {
-        time_t timeDiff = currentTime - game.second.wasUpdated;
-        if (timeDiff > GAME_TIMEOUT_SECONDS) {
-            hangmanGamesToRemove.push_back(game.first);
+void GamesModule::supersedeReplies(uint32_t to, GameKind game)
+{
+    for (auto &entry : txQueue) {
+        if (entry.used && entry.to == to && entry.stateOf == game) {
+            entry.used = false;
+            stats.supersededReplies++;
         }
     }
+}
 
-    // Remove old Hangman games
-    for (uint32_t gameId : hangmanGamesToRemove) {
-        auto &game = activeHangmanGames[gameId];
-        std::string msg = "Hangman game timed out due to inactivity.";
-        
-        if (game.player != 0) {
-            auto reply = allocDataPacket();
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = game.player;
-            service->sendToMesh(reply);
+// A lost state update leaves the client behind, so the next one must be a full resync
+void GamesModule::replyDropped(uint32_t to, GameKind stateOf)
+{
+    if (stateOf != GameKind::AutoChess)
+        return;
+    if (AutoChessGame *game = findAutoChessGame(to)) {
+        auto player = game->players.find(to);
+        if (player != game->players.end())
+            player->second.sent.valid = false;
+    }
+}
+
+uint32_t GamesModule::estimateAirtimeMs(size_t len)
+{
+    return TX_OVERHEAD_MS + (len * TX_US_PER_BYTE + 999) / 1000;
+}
+
+int32_t GamesModule::drainReplies(uint32_t now)
+{
+    // Airtime credit accrues at the budgeted share of wall time, up to one burst
+    uint64_t creditCap = uint64_t(airtimeBurstMs) * 1000;
+    airtimeCredit += uint64_t(now - lastCreditMillis) * airtimePermille;
+    if (airtimeCredit > creditCap)
+        airtimeCredit = creditCap;
+    lastCreditMillis = now;
+
+    while (true) {
+        // Most urgent, then oldest, among the entries whose window has closed
+        QueuedReply *next = nullptr;
+        int32_t nextOpen = -1;
+        for (auto &entry : txQueue) {
+            if (!entry.used)
+                continue;
+            int32_t remaining = static_cast<int32_t>(entry.queuedAt + COALESCE_WINDOW_MS - now);
+            if (!entry.sealed && remaining > 0) {
+                if (nextOpen < 0 || remaining < nextOpen)
+                    nextOpen = remaining;
+                continue;
+            }
+            if (!next || entry.priority < next->priority ||
+                (entry.priority == next->priority && entry.sequence < next->sequence))
+                next = &entry;
         }
-        
-        activeHangmanGames.erase(gameId);
+        if (!next)
+            return nextOpen;
+
+        // Replies to one node leave in the order they were queued, whatever their priority
+        for (auto &entry : txQueue) {
+            if (entry.used && entry.to == next->to && entry.sequence < next->sequence)
+                next = &entry;
+        }
+
+        uint32_t airtime = estimateAirtimeMs(next->length);
+        if (airtimePermille != 0) {
+            uint64_t cost = uint64_t(airtime) * 1000;
+            if (airtimeCredit < cost) {
+                int32_t wait = static_cast<int32_t>((cost - airtimeCredit + airtimePermille - 1) / airtimePermille);
+                return (nextOpen >= 0 && nextOpen < wait) ? nextOpen : wait;
+            }
+            airtimeCredit -= cost;
+        }
+
+        auto reply = allocDataPacket();
+        reply->decoded.payload.size = next->length;
+        memcpy(reply->decoded.payload.bytes, next->text, next->length);
+        reply->to = next->to;
+        if (next->binaryPort)
+            reply->decoded.portnum = GAMES_BINARY_PORTNUM;
+        service->sendToMesh(reply);
+        stats.airtimeMs += airtime;
+        next->used = false;
     }
+}
 
-    // Clean up old Rock Paper Scissors games
-    std::vector<uint32_t> rpsGamesToRemove;
-    for (const auto &game : activeRPSGames) {
-        time_t timeDiff = currentTime - game.second.wasUpdated;
-        if (timeDiff > GAME_TIMEOUT_SECONDS) {
-            rpsGamesToRemove.push_back(game.first);
+void GamesModule::setBinaryClient(uint32_t node, bool binary)
+{
+    uint32_t *empty = nullptr;
+    for (uint32_t &client : binaryClients) {
+        if (client == node) {
+            if (!binary)
+                client = 0;
+            return;
         }
+        if (client == 0 && !empty)
+            empty = &client;
     }
+    if (!binary)
+        return;
 
-    // Remove old Rock Paper Scissors games
-    for (uint32_t gameId : rpsGamesToRemove) {
-        cleanupRPSGame(gameId);
+    // Only a full set replaces a client, taking the slots in turn
+    if (empty) {
+        *empty = node;
+    } else {
+        binaryClients[nextBinaryClient] = node;
+        nextBinaryClient = (nextBinaryClient + 1) % BINARY_CLIENT_SLOTS;
     }
 }
 
-bool GamesModule::handleTicTacToeCommand(const meshtastic_MeshPacket &mp, const char *command)
+bool GamesModule::isBinaryClient(uint32_t node) const
 {
-    if (strncmp(command, "new", 3) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from; // Ensure reply goes only to the sender
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
+    for (uint32_t client : binaryClients) {
+        if (client == node)
+            return node != 0;
+    }
+    return false;
+}
 
-        // Start a new game
-        startNewTicTacToeGame(mp.from, 0); // Second player will be set when they join
-        auto reply = allocReply();
-        const char *msg = "New Tic Tac Toe game started! Waiting for an opponent to join...\nUse 'ttt board' to check the game state if you miss any updates.";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from; // Ensure reply goes only to the sender
-        service->sendToMesh(reply);
+void GamesModule::sendBinary(uint32_t to, const char *data, size_t len, ReplyPriority priority, GameKind stateOf,
+                             bool supersede)
+{
+    if (stateOf != GameKind::None && supersede)
+        supersedeReplies(to, stateOf);
+    queueReply(to, data, len, priority, stateOf, true);
+}
+
+bool GamesModule::sendTicTacToeBinary(uint32_t to, const TicTacToeGame &game, BinaryStatus status,
+                                      ReplyPriority priority, GameKind stateOf)
+{
+    if (!isBinaryClient(to))
+        return false;
+
+    ReplyWriter out = replyWriter();
+    writeTicTacToeBinary(out, game, status, to);
+    sendBinary(to, out.data(), out.size(), priority, stateOf);
+    return true;
+}
+
+void GamesModule::writeTicTacToeBinary(ReplyWriter &out, const TicTacToeGame &game, BinaryStatus status,
+                                       uint32_t viewer)
+{
+    out << static_cast<char>(BinaryReply::TicTacToe) << static_cast<char>(status);
+    out.varint(game.xMask).varint(game.oMask);
+    out << (viewer == game.player1 ? 'X' : 'O');
+}
+
+bool GamesModule::sendHangmanBinary(uint32_t to, const HangmanGame &game, BinaryStatus status, GameKind stateOf)
+{
+    if (!isBinaryClient(to))
+        return false;
+
+    ReplyWriter out = replyWriter();
+    writeHangmanBinary(out, game, status);
+    sendBinary(to, out.data(), out.size(), ReplyPriority::Direct, stateOf);
+    return true;
+}
+
+void GamesModule::writeHangmanBinary(ReplyWriter &out, const HangmanGame &game, BinaryStatus status)
+{
+    bool ended = status == BinaryStatus::Won || status == BinaryStatus::Lost;
+    out << static_cast<char>(BinaryReply::Hangman) << static_cast<char>(status);
+    out.varint(game.remainingGuesses < 0 ? 0 : game.remainingGuesses).varint(game.guessedMask).varint(game.length);
+    for (int i = 0; i < game.length; i++)
+        out << (ended ? game.word[i] : game.letterAt(i));  // The word is revealed once the game is over
+}
+
+// Answers a repeated view request from the cache if nothing changed since it was rendered
+bool GamesModule::sendCachedView(uint32_t to, GameKind game, uint32_t version)
+{
+    bool binary = isBinaryClient(to);
+    for (auto &entry : renderCache) {
+        if (entry.player != to || entry.game != game)
+            continue;
+        if (entry.version != version || entry.binary != binary)
+            break;
+        entry.lastUsed = ++renderCacheClock;
+        stats.cacheHits++;
+        if (binary)
+            sendBinary(to, renderArena + entry.offset, entry.length, ReplyPriority::Direct, game);
+        else
+            sendReply(to, renderArena + entry.offset, entry.length, ReplyPriority::Direct, game);
         return true;
     }
-    else if (strncmp(command, "join", 4) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from; // Ensure reply goes only to the sender
-                service->sendToMesh(reply);
-                return true;
+    stats.cacheMisses++;
+    return false;
+}
+
+// Sends a freshly rendered view and keeps it for repeats, evicting the least
+// recently used entries to stay within RENDER_CACHE_BYTES
+void GamesModule::sendView(uint32_t to, GameKind game, uint32_t version, const ReplyWriter &out)
+{
+    bool binary = isBinaryClient(to);
+    if (binary)
+        sendBinary(to, out.data(), out.size(), ReplyPriority::Direct, game);
+    else
+        sendReply(to, out, ReplyPriority::Direct, game);
+
+    RenderCacheEntry *slot = nullptr;
+    for (auto &entry : renderCache) {
+        if (entry.player == to && entry.game == game) {
+            slot = &entry;
+            break;
+        }
+        if (!slot || (slot->player != 0 && (entry.player == 0 || entry.lastUsed < slot->lastUsed)))
+            slot = &entry;
+    }
+    dropCachedView(*slot);
+    if (out.size() == 0 || out.size() > RENDER_CACHE_BYTES || out.overflowed())
+        return;
+
+    while (renderCacheBytes + out.size() > RENDER_CACHE_BYTES) {
+        RenderCacheEntry *victim = nullptr;
+        for (auto &entry : renderCache) {
+            if (entry.player != 0 && (!victim || entry.lastUsed < victim->lastUsed))
+                victim = &entry;
+        }
+        dropCachedView(*victim);
+    }
+    if (renderArenaEnd + out.size() > RENDER_CACHE_BYTES)
+        compactRenderArena();
+
+    slot->player = to;
+    slot->game = game;
+    slot->binary = binary;
+    slot->version = version;
+    slot->lastUsed = ++renderCacheClock;
+    slot->offset = renderArenaEnd;
+    slot->length = out.size();
+    memcpy(renderArena + renderArenaEnd, out.data(), out.size());
+    renderArenaEnd += out.size();
+    renderCacheBytes += out.size();
+}
+
+void GamesModule::dropCachedView(RenderCacheEntry &entry)
+{
+    if (entry.player == 0)
+        return;
+    renderCacheBytes -= entry.length;
+    entry.player = 0;
+    entry.length = 0;
+}
+
+// Slides the live entries to the front of the arena, keeping their order, so
+// all free bytes end up after renderArenaEnd
+void GamesModule::compactRenderArena()
+{
+    size_t end = 0;
+    for (;;) {
+        RenderCacheEntry *first = nullptr;
+        for (auto &entry : renderCache) {
+            if (entry.player != 0 && entry.offset >= end && (!first || entry.offset < first->offset))
+                first = &entry;
+        }
+        if (!first)
+            break;
+        memmove(renderArena + end, renderArena + first->offset, first->length);
+        first->offset = end;
+        end += first->length;
+    }
+    renderArenaEnd = end;
+}
+
+bool GamesModule::sendRPSBinary(uint32_t to, const RPSGame &game, ReplyPriority priority)
+{
+    if (!isBinaryClient(to))
+        return false;
+
+    uint8_t outcome = 2;
+    if (game.player1Choice == game.player2Choice)
+        outcome = 0;
+    else if ((game.player1Choice == 'R' && game.player2Choice == 'S') ||
+             (game.player1Choice == 'P' && game.player2Choice == 'R') ||
+             (game.player1Choice == 'S' && game.player2Choice == 'P'))
+        outcome = 1;
+    ReplyWriter out = replyWriter();
+    out << static_cast<char>(BinaryReply::RPS) << game.player1Choice << game.player2Choice;
+    out.varint(outcome).varint(game.isBotGame ? 1 : 0);
+    sendBinary(to, out.data(), out.size(), priority, GameKind::None);
+    return true;
+}
+
+bool GamesModule::cmdStats(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    ReplyWriter out = replyWriter();
+    out << "Games stats:\n"
+        << "Commands: " << stats.commandsHandled << "\n"
+        << "Rejected: " << stats.rejectedMessages << " msgs, " << stats.rejectedBytes << " bytes\n"
+        << "Fragmented: " << stats.fragmentedReplies << " replies, " << stats.fragmentsSent << " packets, "
+        << stats.truncatedReplies << " truncated\n"
+        << "Coalesced: " << stats.coalescedReplies << " packets saved\n"
+        << "TX: " << stats.supersededReplies << " superseded, " << stats.droppedReplies << " dropped, "
+        << stats.airtimeMs << " ms airtime\n"
+        << "Render cache: " << stats.cacheHits << " hits, " << stats.cacheMisses << " misses, " << renderCacheBytes
+        << " bytes";
+    sendReply(mp.from, out);
+    return true;
+}
+
+bool GamesModule::cmdHelp(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    const char *msg = "Games: TicTacToe(t), Hangman(h), RockPaperScissors(r) & AutoChess(ac)\n"
+                     "t: new/join [hops]/bot [easy|medium|hard]/board/[1-9]\n"
+                     "h: new [easy|medium|hard]/state/[letter]\n"
+                     "r: new/join [hops]/bot/[R/P/S]\n"
+                     "ac: new/join [id]/state/buy/sell/place/log";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+void LobbyQueue::push(LobbyLink &link, uint32_t gameId, uint8_t hostHops)
+{
+    if (link.queued)
+        return;
+
+    link.gameId = gameId;
+    link.hostHops = hostHops;
+    link.prev = tail;
+    link.next = nullptr;
+    if (tail)
+        tail->next = &link;
+    else
+        head = &link;
+    tail = &link;
+    link.queued = true;
+}
+
+void LobbyQueue::remove(LobbyLink &link)
+{
+    if (!link.queued)
+        return;
+
+    (link.prev ? link.prev->next : head) = link.next;
+    (link.next ? link.next->prev : tail) = link.prev;
+    link.prev = nullptr;
+    link.next = nullptr;
+    link.queued = false;
+}
+
+LobbyLink *LobbyQueue::front(uint8_t maxHops) const
+{
+    for (LobbyLink *link = head; link; link = link->next) {
+        if (link->hostHops <= maxHops)
+            return link;
+    }
+    return nullptr;
+}
+
+// Hops the packet travelled, or LOBBY_ANY_HOPS if the sender does not report hop_start
+uint8_t GamesModule::hopsAway(const meshtastic_MeshPacket &mp)
+{
+    if (mp.hop_start == 0 || mp.hop_start < mp.hop_limit)
+        return LOBBY_ANY_HOPS;
+    return mp.hop_start - mp.hop_limit;
+}
+
+// Optional "join <max_hops>" argument; without it any host matches
+uint8_t GamesModule::hopFilter(const CommandArgs &args)
+{
+    if (args.count == 0 || args.values[0] < 0 || args.values[0] >= LOBBY_ANY_HOPS)
+        return LOBBY_ANY_HOPS;
+    return static_cast<uint8_t>(args.values[0]);
+}
+
+uint32_t GamesModule::findSession(uint32_t player, GameKind game) const
+{
+    auto it = playerSessions.find(player);
+    return it == playerSessions.end() ? 0 : it->second.gameIds[static_cast<size_t>(game)];
+}
+
+void GamesModule::setSession(uint32_t player, GameKind game, uint32_t gameId)
+{
+    // Empty seats and bots are stored as node 0 and are never indexed
+    if (player == 0)
+        return;
+    playerSessions[player].gameIds[static_cast<size_t>(game)] = gameId;
+}
+
+void GamesModule::clearSession(uint32_t player, GameKind game)
+{
+    auto it = playerSessions.find(player);
+    if (it == playerSessions.end())
+        return;
+
+    it->second.gameIds[static_cast<size_t>(game)] = 0;
+    for (uint32_t gameId : it->second.gameIds) {
+        if (gameId != 0)
+            return;
+    }
+    playerSessions.erase(it);
+}
+
+TicTacToeGame *GamesModule::findTicTacToeGame(uint32_t player)
+{
+    auto it = activeGames.find(findSession(player, GameKind::TicTacToe));
+    return it == activeGames.end() ? nullptr : &it->second;
+}
+
+RPSGame *GamesModule::findRPSGame(uint32_t player)
+{
+    auto it = activeRPSGames.find(findSession(player, GameKind::RPS));
+    return it == activeRPSGames.end() ? nullptr : &it->second;
+}
+
+AutoChessGame *GamesModule::findAutoChessGame(uint32_t player)
+{
+    auto it = activeAutoChessGames.find(findSession(player, GameKind::AutoChess));
+    return it == activeAutoChessGames.end() ? nullptr : &it->second;
+}
+
+void TimerWheel::link(GameTimer *&slot, GameTimer &timer)
+{
+    timer.next = slot;
+    if (slot)
+        slot->pprev = &timer.next;
+    slot = &timer;
+    timer.pprev = &slot;
+}
+
+GameTimer *&TimerWheel::slotFor(uint32_t expiresAt)
+{
+    uint32_t delta = expiresAt - currentTick;
+    if (delta < WHEEL_SLOTS)
+        return level0[expiresAt & (WHEEL_SLOTS - 1)];
+    if (delta < WHEEL_SLOTS * WHEEL_SLOTS)
+        return level1[(expiresAt >> WHEEL_BITS) & (WHEEL_SLOTS - 1)];
+    return level1[((currentTick >> WHEEL_BITS) - 1) & (WHEEL_SLOTS - 1)];
+}
+
+void TimerWheel::schedule(GameTimer &timer, uint32_t now, uint32_t expiresAt)
+{
+    cancel(timer);
+
+    // An empty wheel is not advanced while the scheduler sleeps; catch it up for free
+    if (armedCount == 0)
+        currentTick = now;
+
+    // Timers already due fire on the next tick
+    if (static_cast<int32_t>(expiresAt - currentTick) <= 0)
+        expiresAt = currentTick + 1;
+
+    timer.expiresAt = expiresAt;
+    timer.armed = true;
+    armedCount++;
+    link(slotFor(expiresAt), timer);
+}
+
+void TimerWheel::cancel(GameTimer &timer)
+{
+    if (!timer.armed)
+        return;
+
+    *timer.pprev = timer.next;
+    if (timer.next)
+        timer.next->pprev = timer.pprev;
+
+    timer.pprev = nullptr;
+    timer.next = nullptr;
+    timer.armed = false;
+    armedCount--;
+}
+
+GameTimer *TimerWheel::advance(uint32_t now)
+{
+    GameTimer *expired = nullptr;
+    auto expire = [&](GameTimer *timer) {
+        timer->armed = false;
+        timer->pprev = nullptr;
+        timer->next = expired;
+        expired = timer;
+        armedCount--;
+    };
+
+    if (armedCount == 0) {
+        currentTick = now;
+        return nullptr;
+    }
+
+    // More than a full revolution behind: rather than stepping through every
+    // missed tick, take all timers out, jump to now and re-file the rest
+    if (now - currentTick > WHEEL_SLOTS * WHEEL_SLOTS) {
+        GameTimer *pending = nullptr;
+        for (GameTimer **slots : {level0, level1}) {
+            for (uint32_t i = 0; i < WHEEL_SLOTS; i++) {
+                while (GameTimer *timer = slots[i]) {
+                    slots[i] = timer->next;
+                    timer->next = pending;
+                    pending = timer;
+                }
             }
         }
+        currentTick = now;
+        while (pending) {
+            GameTimer *next = pending->next;
+            if (static_cast<int32_t>(pending->expiresAt - now) <= 0)
+                expire(pending);
+            else
+                link(slotFor(pending->expiresAt), *pending);
+            pending = next;
+        }
+        return expired;
+    }
+
+    while (currentTick != now) {
+        currentTick++;
 
-        // List available games
-        std::vector<uint32_t> availableGames;
-        for (const auto &game : activeGames) {
-            if (game.second.player2 == 0 && game.second.player1 != mp.from) {
-                availableGames.push_back(game.first);
+        // Every WHEEL_SLOTS ticks, re-file the next level 1 slot into level 0
+        if ((currentTick & (WHEEL_SLOTS - 1)) == 0) {
+            GameTimer *&slot1 = level1[(currentTick >> WHEEL_BITS) & (WHEEL_SLOTS - 1)];
+            GameTimer *timer = slot1;
+            slot1 = nullptr;
+            while (timer) {
+                GameTimer *next = timer->next;
+                link(slotFor(timer->expiresAt), *timer);
+                timer = next;
             }
         }
 
-        if (availableGames.empty()) {
-            auto reply = allocReply();
-            const char *msg = "No games available to join. Start a new game with 'ttt new'";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from; // Ensure reply goes only to the sender
-            service->sendToMesh(reply);
-            return true;
+        GameTimer *&slot0 = level0[currentTick & (WHEEL_SLOTS - 1)];
+        GameTimer *timer = slot0;
+        slot0 = nullptr;
+        while (timer) {
+            GameTimer *next = timer->next;
+            expire(timer);
+            timer = next;
         }
+    }
 
-        // Join the first available game
-        auto &game = activeGames[availableGames[0]];
-        game.player2 = mp.from;
-        game.currentPlayer = game.player1;
+    return expired;
+}
 
-        // Notify both players
-        auto reply = allocReply();
-        std::string msg = "Game started! You are O. Waiting for opponent's move...\n" + getBoardString(game);
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = mp.from; // Send to the joining player
-        service->sendToMesh(reply);
+void GamesModule::setGameTimeout(GameKind game, uint32_t seconds)
+{
+    gameTimeouts[static_cast<size_t>(game)] = seconds;
+}
+
+void GamesModule::setAirtimeBudget(uint16_t permille, uint32_t burstMs)
+{
+    airtimePermille = permille;
+    airtimeBurstMs = burstMs;
+    airtimeCredit = uint64_t(burstMs) * 1000;
+    lastCreditMillis = millis();
+}
+
+void GamesModule::updateTick()
+{
+    // Accumulate millis() deltas so the tick keeps counting across its 49 day wrap
+    uint32_t nowMillis = millis();
+    tickRemainderMs += nowMillis - lastTickMillis;
+    lastTickMillis = nowMillis;
+    nowTick += tickRemainderMs / 1000;
+    tickRemainderMs %= 1000;
+}
+
+void GamesModule::scheduleTimeout(GameKind game, uint32_t gameId, GameTimer &timer)
+{
+    timer.game = game;
+    timer.gameId = gameId;
+    gameTimers.schedule(timer, nowTick, nowTick + gameTimeouts[static_cast<size_t>(game)]);
+    wakeScheduler();
+}
+
+void GamesModule::wakeScheduler(uint32_t delayMs)
+{
+    if (!OSThread::enabled) {
+        OSThread::enabled = true;
+        setIntervalFromNow(delayMs);
+    } else if (tillRun(millis()) > static_cast<int32_t>(delayMs)) {
+        setIntervalFromNow(delayMs);
+    }
+}
+
+void GamesModule::scheduleRound(uint32_t gameId, AutoChessGame &game, uint32_t dueTick)
+{
+    game.nextRoundTick = dueTick;
+    game.roundToken = ++nextRoundToken;
+    roundHeap.push_back({dueTick, gameId, game.roundToken});
+    std::push_heap(roundHeap.begin(), roundHeap.end(), std::greater<RoundDeadline>());
+    wakeScheduler();
+}
+
+int32_t GamesModule::runOnce()
+{
+    updateTick();
+    expireGames();
+
+    // Run due rounds, oldest deadline first, until the budget is used up
+    uint32_t start = millis();
+    while (!roundHeap.empty() && static_cast<int32_t>(roundHeap.front().dueTick - nowTick) <= 0) {
+        if (millis() - start >= ROUND_BUDGET_MS)
+            return ROUND_YIELD_MS;  // Let the radio loop run before the remaining rounds
+        if (!hasReplyRoom(AUTOCHESS_MAX_PLAYERS))
+            break;  // The results would not fit; the round stays due until the queue drains
+
+        RoundDeadline due = roundHeap.front();
+        std::pop_heap(roundHeap.begin(), roundHeap.end(), std::greater<RoundDeadline>());
+        roundHeap.pop_back();
+
+        auto it = activeAutoChessGames.find(due.gameId);
+        if (it == activeAutoChessGames.end() || it->second.roundToken != due.token || !it->second.isActive)
+            continue;  // Game ended or was rescheduled
+
+        processRound(it->second);
+
+        // Keep the cadence unless we fell more than a whole interval behind
+        uint32_t nextDue = due.dueTick + BATTLE_INTERVAL_SECONDS;
+        if (static_cast<int32_t>(nextDue - nowTick) <= 0)
+            nextDue = nowTick + BATTLE_INTERVAL_SECONDS;
+        scheduleRound(due.gameId, it->second, nextDue);
+    }
+
+    // Send queued replies whose window has closed, as far as the airtime budget allows
+    int32_t nextFlush = drainReplies(millis());
+
+    // Sleep until the next tick while games exist, otherwise until a game is touched
+    if (activeGames.empty() && activeHangmanGames.empty() && activeRPSGames.empty() && activeAutoChessGames.empty())
+        return nextFlush >= 0 ? nextFlush : disable();
+    if (nextFlush >= 0 && nextFlush < static_cast<int32_t>(SCHEDULER_INTERVAL_MS))
+        return nextFlush;
+    return SCHEDULER_INTERVAL_MS;
+}
 
-        // Notify the first player
-        auto reply2 = allocDataPacket(); // Use allocDataPacket for the second message
-        std::string msg2 = "Opponent joined! You are X. Your turn to move X!\n" + getBoardString(game);
-        reply2->decoded.payload.size = msg2.length();
-        memcpy(reply2->decoded.payload.bytes, msg2.c_str(), reply2->decoded.payload.size);
-        reply2->to = game.player1;
-        service->sendToMesh(reply2);
+void GamesModule::expireGames()
+{
+    GameTimer *timer = gameTimers.advance(nowTick);
+    while (timer) {
+        // Read the link first, the cleanup below frees the game holding the timer
+        GameTimer *next = timer->next;
+        if (!hasReplyRoom(AUTOCHESS_MAX_PLAYERS)) {
+            // No room for the notices; try again on the next tick
+            gameTimers.schedule(*timer, nowTick, nowTick + 1);
+            timer = next;
+            continue;
+        }
+        LOG_DEBUG("Game %u (type %d) timed out\n", timer->gameId, static_cast<int>(timer->game));
+        switch (timer->game) {
+        case GameKind::TicTacToe:
+            cleanupTicTacToeGame(timer->gameId);
+            break;
+        case GameKind::Hangman:
+            cleanupHangmanGame(timer->gameId);
+            break;
+        case GameKind::RPS:
+            cleanupRPSGame(timer->gameId);
+            break;
+        case GameKind::AutoChess:
+            cleanupAutoChessGame(timer->gameId);
+            break;
+        default:
+            break;
+        }
+        timer = next;
+    }
+}
+
+void GamesModule::cleanupTicTacToeGame(uint32_t gameId)
+{
+    auto it = activeGames.find(gameId);
+    if (it == activeGames.end())
+        return;
+
+    auto &game = it->second;
+    const char *msg = "Game timed out due to inactivity.";
+    
+    // Notify player 1 if they exist
+    if (game.player1 != 0) {
+        sendReply(game.player1, msg, ReplyPriority::Broadcast);
+    }
+    
+    // Notify player 2 if they exist
+    if (game.player2 != 0) {
+        sendReply(game.player2, msg, ReplyPriority::Broadcast);
+    }
+    
+    clearSession(game.player1, GameKind::TicTacToe);
+    clearSession(game.player2, GameKind::TicTacToe);
+    ticTacToeLobby.remove(game.lobby);
+    gameTimers.cancel(game.timer);
+    activeGames.erase(it);
+}
+
+void GamesModule::cleanupHangmanGame(uint32_t gameId)
+{
+    auto it = activeHangmanGames.find(gameId);
+    if (it == activeHangmanGames.end())
+        return;
 
+    auto &game = it->second;
+    const char *msg = "Hangman game timed out due to inactivity.";
+    
+    if (game.player != 0) {
+        sendReply(game.player, msg, ReplyPriority::Broadcast);
+    }
+    
+    clearSession(game.player, GameKind::Hangman);
+    gameTimers.cancel(game.timer);
+    activeHangmanGames.erase(it);
+}
+
+bool GamesModule::cmdTicTacToeNew(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Check if player already has an active game
+    if (findTicTacToeGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
         return true;
     }
-    else if (strncmp(command, "board", 5) == 0) {
-        // Find player's active game
-        for (const auto &game : activeGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                std::string msg = "Current game state:\n" + getBoardString(game.second);
-                if (game.second.currentPlayer == mp.from) {
-                    msg += "\nYour turn to move " + std::string(game.second.currentPlayer == game.second.player1 ? "X" : "O") + "!";
-                } else {
-                    msg += "\nWaiting for opponent's move...";
-                }
-                reply->decoded.payload.size = msg.length();
-                memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
+
+    // Start a new game
+    startNewTicTacToeGame(mp.from, 0); // Second player will be set when they join
+    ticTacToeLobby.push(activeGames[mp.from].lobby, mp.from, hopsAway(mp));
+    const char *msg = "New Tic Tac Toe game started! Waiting for an opponent to join...\nUse 'ttt board' to check the game state if you miss any updates.";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+bool GamesModule::cmdTicTacToeJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Check if player already has an active game
+    if (findTicTacToeGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    // Take the oldest open game, optionally only from hosts within N hops
+    LobbyLink *open = ticTacToeLobby.front(hopFilter(args));
+    if (!open) {
+        const char *msg = "No games available to join. Start a new game with 'ttt new'";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    // Join the game
+    uint32_t gameId = open->gameId;
+    ticTacToeLobby.remove(*open);
+    auto &game = activeGames[gameId];
+    game.player2 = mp.from;
+    game.currentPlayer = game.player1;
+    setSession(mp.from, GameKind::TicTacToe, gameId);
+    touchGame(GameKind::TicTacToe, gameId, game);
+
+    // Notify both players
+    if (!sendTicTacToeBinary(mp.from, game, BinaryStatus::OpponentTurn, ReplyPriority::Direct, GameKind::None)) {
+        ReplyWriter out = replyWriter();
+        out << "Game started! You are O. Waiting for opponent's move...\n";
+        writeBoard(out, game);
+        sendReply(mp.from, out);
+    }
+
+    // Notify the first player
+    if (!sendTicTacToeBinary(game.player1, game, BinaryStatus::YourTurn, ReplyPriority::Turn, GameKind::None)) {
+        ReplyWriter out = replyWriter();
+        out << "Opponent joined! You are X. Your turn to move X!\n";
+        writeBoard(out, game);
+        sendReply(game.player1, out, ReplyPriority::Turn);
+    }
+
+    return true;
+}
+
+bool GamesModule::cmdTicTacToeBot(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Check if player already has an active game
+    if (findTicTacToeGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    const TicTacToeBotLevel *level = &TTT_BOT_LEVELS[TTT_DEFAULT_BOT_LEVEL];
+    if (!args.word.empty()) {
+        level = nullptr;
+        for (const auto &candidate : TTT_BOT_LEVELS) {
+            if (candidate.name == args.word)
+                level = &candidate;
+        }
+        if (!level) {
+            const char *msg = "Usage: ttt bot [easy|medium|hard]";
+            sendReply(mp.from, msg);
+            return true;
+        }
+    }
+
+    // Start a new game against the bot, which plays O and is never queued
+    startNewTicTacToeGame(mp.from, 0);
+    auto &game = activeGames[mp.from];
+    game.isBotGame = true;
+    game.botRandomPercent = level->randomPercent;
+
+    if (!sendTicTacToeBinary(mp.from, game, BinaryStatus::YourTurn, ReplyPriority::Direct, GameKind::None)) {
+        ReplyWriter out = replyWriter();
+        out << "New Tic Tac Toe game against the bot (" << level->name << ")! You are X. Your turn to move X!\n";
+        writeBoard(out, game);
+        sendReply(mp.from, out);
+    }
+    return true;
+}
+
+bool GamesModule::cmdTicTacToeBoard(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Find player's active game
+    if (const TicTacToeGame *game = findTicTacToeGame(mp.from)) {
+        if (sendCachedView(mp.from, GameKind::TicTacToe, game->version))
+            return true;
+
+        ReplyWriter out = replyWriter();
+        if (isBinaryClient(mp.from)) {
+            BinaryStatus status = game->currentPlayer == mp.from ? BinaryStatus::YourTurn : BinaryStatus::OpponentTurn;
+            writeTicTacToeBinary(out, *game, status, mp.from);
+        } else {
+            out << "Current game state:\n";
+            writeBoard(out, *game);
+            if (game->currentPlayer == mp.from) {
+                out << "\nYour turn to move " << (game->currentPlayer == game->player1 ? 'X' : 'O') << '!';
+            } else {
+                out << "\nWaiting for opponent's move...";
             }
         }
-        
-        // No active game found
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game. Start one with 'ttt new' or join one with 'ttt join'";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+        sendView(mp.from, GameKind::TicTacToe, game->version, out);
         return true;
     }
-    else if (isdigit(command[0])) {
-        // Make a move
-        int position = command[0] - '1'; // Convert from 1-9 to 0-8
-        return handleTicTacToeMove(mp, position);
-    }
+    
+    // No active game found
+    const char *msg = "You don't have an active game. Start one with 'ttt new' or join one with 'ttt join'";
+    sendReply(mp.from, msg);
+    return true;
+}
 
-    return false;
+bool GamesModule::cmdTicTacToeMove(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    if (!isdigit(static_cast<unsigned char>(args.letter)))
+        return false;
+
+    // Make a move
+    int position = args.letter - '1'; // Convert from 1-9 to 0-8
+    return handleTicTacToeMove(mp, position);
 }
 
 void GamesModule::startNewTicTacToeGame(uint32_t player1, uint32_t player2)
 {
     TicTacToeGame game;
-    memset(game.board, ' ', sizeof(game.board));
+    game.xMask = 0;
+    game.oMask = 0;
     game.player1 = player1;
     game.player2 = player2;
     game.currentPlayer = player1;
-    game.wasUpdated = time(nullptr);  // Set creation time
+    seedGame(game.rng, GameKind::TicTacToe, player1);
     activeGames[player1] = game;
+    touchGame(GameKind::TicTacToe, player1, activeGames[player1]);
+    setSession(player1, GameKind::TicTacToe, player1);
+    setSession(player2, GameKind::TicTacToe, player1);
 }
 
 bool GamesModule::handleTicTacToeMove(const meshtastic_MeshPacket &mp, int position)
@@ -359,60 +1458,70 @@ bool GamesModule::handleTicTacToeMove(const meshtastic_MeshPacket &mp, int posit
     if (position < 0 || position > 8)
         return false;
 
-    for (auto it = activeGames.begin(); it != activeGames.end(); ++it) {
+    auto it = activeGames.find(findSession(mp.from, GameKind::TicTacToe));
+    if (it != activeGames.end()) {
         auto &game = it->second;
-        if ((game.player1 == mp.from || game.player2 == mp.from) && 
-            game.currentPlayer == mp.from && 
-            game.board[position] == ' ') {
+        uint16_t square = 1u << position;
+        if (game.currentPlayer == mp.from && !((game.xMask | game.oMask) & square)) {
 
             // Update the game's last activity time before making any changes
-            game.wasUpdated = time(nullptr);
-            game.board[position] = (mp.from == game.player1) ? 'X' : 'O';
+            touchGame(GameKind::TicTacToe, it->first, game);
+            if (mp.from == game.player1)
+                game.xMask |= square;
+            else
+                game.oMask |= square;
             
-            // Create message for both players
-            std::string boardState = getBoardString(game);
-            bool gameEnded = false;
-            std::string endMessage;
-            
-            if (checkWin(game)) {
-                endMessage = "\nGame Over! " + std::string(mp.from == game.player1 ? "X" : "O") + " wins!";
-                gameEnded = true;
-            }
-            else if (checkDraw(game)) {
-                endMessage = "\nGame Over! It's a draw!";
-                gameEnded = true;
+            BinaryStatus endStatus = BinaryStatus::Playing;
+            const char *endMessage = ticTacToeEnd(game, endStatus);
+
+            // The bot answers straight away, so the turn stays with the player
+            int botSquare = -1;
+            if (!endMessage && game.isBotGame) {
+                botSquare = chooseBotMove(game);
+                game.oMask |= 1u << botSquare;
+                endMessage = ticTacToeEnd(game, endStatus);
             }
+
+            bool gameEnded = endMessage != nullptr;
+            GameKind stateOf = gameEnded ? GameKind::None : GameKind::TicTacToe;  // Never supersede the result
+            if (!gameEnded && !game.isBotGame)
+                game.currentPlayer = (game.currentPlayer == game.player1) ? game.player2 : game.player1;
             
             // Send to the player who made the move
-            auto reply = allocDataPacket();
-            std::string msg = boardState;
-            if (gameEnded) {
-                msg += endMessage;
-            } else {
-                game.currentPlayer = (game.currentPlayer == game.player1) ? 
-                                   game.player2 : game.player1;
-                msg += "\nWaiting for opponent's move...";
+            BinaryStatus moverStatus = game.isBotGame ? BinaryStatus::YourTurn : BinaryStatus::OpponentTurn;
+            if (!sendTicTacToeBinary(mp.from, game, gameEnded ? endStatus : moverStatus, ReplyPriority::Direct, stateOf)) {
+                ReplyWriter out = replyWriter();
+                if (botSquare >= 0)
+                    out << "Bot played " << char('1' + botSquare) << '\n';
+                writeBoard(out, game);
+                if (gameEnded) {
+                    out << endMessage;
+                } else {
+                    out << (game.isBotGame ? "\nYour turn to move X!" : "\nWaiting for opponent's move...");
+                }
+                sendReply(mp.from, out, ReplyPriority::Direct, stateOf);
             }
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-
-            // Send to the other player
-            auto reply2 = allocDataPacket();
-            std::string msg2 = boardState;
-            if (gameEnded) {
-                msg2 += endMessage;
-            } else {
-                msg2 += "\nYour turn to move " + std::string(game.currentPlayer == game.player1 ? "X" : "O") + "!";
+
+            // Send to the other player, unless it is the bot
+            uint32_t opponent = (mp.from == game.player1) ? game.player2 : game.player1;
+            if (opponent != 0 && !sendTicTacToeBinary(opponent, game, gameEnded ? endStatus : BinaryStatus::YourTurn,
+                                                      ReplyPriority::Turn, stateOf)) {
+                ReplyWriter out = replyWriter();
+                writeBoard(out, game);
+                if (gameEnded) {
+                    out << endMessage;
+                } else {
+                    out << "\nYour turn to move " << (game.currentPlayer == game.player1 ? 'X' : 'O') << '!';
+                }
+                sendReply(opponent, out, ReplyPriority::Turn, stateOf);
             }
-            reply2->decoded.payload.size = msg2.length();
-            memcpy(reply2->decoded.payload.bytes, msg2.c_str(), reply2->decoded.payload.size);
-            reply2->to = (mp.from == game.player1) ? game.player2 : game.player1;
-            service->sendToMesh(reply2);
 
             // Remove the game if it ended
             if (gameEnded) {
+                clearSession(game.player1, GameKind::TicTacToe);
+                clearSession(game.player2, GameKind::TicTacToe);
+                ticTacToeLobby.remove(game.lobby);
+                gameTimers.cancel(game.timer);
                 activeGames.erase(it);
             }
 
@@ -422,86 +1531,207 @@ bool GamesModule::handleTicTacToeMove(const meshtastic_MeshPacket &mp, int posit
     return false;
 }
 
-std::string GamesModule::getBoardString(const TicTacToeGame &game)
+void GamesModule::writeBoard(ReplyWriter &out, const TicTacToeGame &game)
 {
-    std::stringstream ss;
-    ss << "\n";
+    out << '\n';
     for (int i = 0; i < 9; i += 3) {
-        ss << " " << (game.board[i] == ' ' ? std::to_string(i+1) : std::string(1, game.board[i])) << " | "
-           << (game.board[i+1] == ' ' ? std::to_string(i+2) : std::string(1, game.board[i+1])) << " | "
-           << (game.board[i+2] == ' ' ? std::to_string(i+3) : std::string(1, game.board[i+2])) << "\n";
-        if (i < 6) ss << "---+---+---\n";
+        for (int j = i; j < i + 3; j++) {
+            char square = game.squareAt(j);
+            out << (j == i ? " " : " | ") << (square == ' ' ? char('1' + j) : square);
+        }
+        out << '\n';
+        if (i < 6) out << "---+---+---\n";
     }
-    return ss.str();
 }
 
-bool GamesModule::checkWin(const TicTacToeGame &game)
+bool GamesModule::checkDraw(const TicTacToeGame &game)
 {
-    // Check rows
-    for (int i = 0; i < 9; i += 3) {
-        if (game.board[i] != ' ' && game.board[i] == game.board[i+1] && game.board[i] == game.board[i+2])
-            return true;
+    return __builtin_popcount(game.xMask | game.oMask) == 9;
+}
+
+// Final message and status once the game is over, nullptr while it goes on
+const char *GamesModule::ticTacToeEnd(const TicTacToeGame &game, BinaryStatus &status)
+{
+    if (hasTicTacToeLine(game.xMask)) {
+        status = BinaryStatus::XWins;
+        return game.isBotGame ? "\nGame Over! You win!" : "\nGame Over! X wins!";
     }
-    
-    // Check columns
-    for (int i = 0; i < 3; i++) {
-        if (game.board[i] != ' ' && game.board[i] == game.board[i+3] && game.board[i] == game.board[i+6])
-            return true;
+    if (hasTicTacToeLine(game.oMask)) {
+        status = BinaryStatus::OWins;
+        return game.isBotGame ? "\nGame Over! The bot wins!" : "\nGame Over! O wins!";
     }
-    
-    // Check diagonals
-    if (game.board[0] != ' ' && game.board[0] == game.board[4] && game.board[0] == game.board[8])
-        return true;
-    if (game.board[2] != ' ' && game.board[2] == game.board[4] && game.board[2] == game.board[6])
-        return true;
-    
-    return false;
+    if (checkDraw(game)) {
+        status = BinaryStatus::Draw;
+        return "\nGame Over! It's a draw!";
+    }
+    return nullptr;
 }
 
-bool GamesModule::checkDraw(const TicTacToeGame &game)
+// Best square from the precomputed table, or now and then a random free one
+int GamesModule::chooseBotMove(TicTacToeGame &game)
 {
-    for (int i = 0; i < 9; i++) {
-        if (game.board[i] == ' ')
-            return false;
+    uint16_t taken = game.xMask | game.oMask;
+
+    if (game.rng.below(100) < game.botRandomPercent) {
+        int pick = game.rng.below(9 - __builtin_popcount(taken));
+        for (int square = 0; square < 9; square++) {
+            if (!(taken & (1u << square)) && pick-- == 0)
+                return square;
+        }
+    }
+
+    int index = ticTacToeIndex(game.xMask, game.oMask);
+    return (TTT_MOVES[index / 2] >> (index % 2 * 4)) & 0xF;
+}
+
+#if ARCH_PORTDUINO
+HangmanDictionary::~HangmanDictionary()
+{
+    if (data)
+        munmap(const_cast<char *>(data), size);
+}
+
+bool HangmanDictionary::open(const char *path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= HEADER_LEN)
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOG_WARN("Hangman dictionary %s could not be mapped\n", path);
+        return false;
+    }
+
+    // Only the header is checked; word pages are faulted in when a word is picked
+    const char *bytes = static_cast<const char *>(map);
+    const Bucket *table = reinterpret_cast<const Bucket *>(bytes + 8);
+    bool valid = memcmp(bytes, "HMD1", 4) == 0;
+    for (int length = 0; valid && length <= MAX_LENGTH; length++) {
+        for (int difficulty = 0; difficulty < DIFFICULTIES; difficulty++) {
+            const Bucket &bucket = table[length * DIFFICULTIES + difficulty];
+            if (bucket.offset > static_cast<size_t>(st.st_size) ||
+                uint64_t(bucket.count) * length > static_cast<size_t>(st.st_size) - bucket.offset)
+                valid = false;
+        }
+    }
+    if (!valid) {
+        LOG_WARN("Hangman dictionary %s is not valid\n", path);
+        munmap(map, st.st_size);
+        return false;
     }
+
+    madvise(map, st.st_size, MADV_RANDOM);
+    data = bytes;
+    size = st.st_size;
+    buckets = table;
     return true;
 }
 
-std::string GamesModule::getRandomWord()
+uint32_t HangmanDictionary::count(int difficulty) const
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, HANGMAN_WORDS_COUNT - 1);
-    return HANGMAN_WORDS[dis(gen)];
+    uint32_t total = 0;
+    for (int length = 1; buckets && length <= MAX_LENGTH; length++) {
+        for (int d = 0; d < DIFFICULTIES; d++) {
+            if (difficulty < 0 || d == difficulty)
+                total += buckets[length * DIFFICULTIES + d].count;
+        }
+    }
+    return total;
+}
+
+// Buckets hold words of a single length, so the n-th word is found by
+// skipping whole buckets and one multiplication
+std::string_view HangmanDictionary::word(int difficulty, uint32_t n) const
+{
+    for (int length = 1; buckets && length <= MAX_LENGTH; length++) {
+        for (int d = 0; d < DIFFICULTIES; d++) {
+            if (difficulty >= 0 && d != difficulty)
+                continue;
+            const Bucket &bucket = buckets[length * DIFFICULTIES + d];
+            if (n < bucket.count)
+                return std::string_view(data + bucket.offset + size_t(n) * length, length);
+            n -= bucket.count;
+        }
+    }
+    return {};
 }
+#endif
 
-void GamesModule::startNewHangmanGame(uint32_t player)
+// Picks from the external dictionary when there is one, otherwise from the
+// built-in list. A difficulty with no words falls back to any word.
+std::string_view GamesModule::getRandomWord(GamesRandom &rng, int difficulty)
 {
-    HangmanGame game;
-    game.word = getRandomWord();
+#if ARCH_PORTDUINO
+    uint32_t available = hangmanDictionary.count(difficulty);
+    if (available == 0)
+        available = hangmanDictionary.count(difficulty = -1);
+    if (available > 0)
+        return hangmanDictionary.word(difficulty, rng.below(available));
+#endif
+
+    int matching = 0;
+    for (int i = 0; i < HANGMAN_WORDS_COUNT; i++)
+        matching += difficulty < 0 || hangmanDifficulty(HANGMAN_WORDS[i]) == difficulty;
+    if (matching == 0) {
+        difficulty = -1;
+        matching = HANGMAN_WORDS_COUNT;
+    }
+
+    int pick = rng.below(matching);
+    for (int i = 0; i < HANGMAN_WORDS_COUNT; i++) {
+        if ((difficulty < 0 || hangmanDifficulty(HANGMAN_WORDS[i]) == difficulty) && pick-- == 0)
+            return HANGMAN_WORDS[i];
+    }
+    return HANGMAN_WORDS[0];
+}
+
+void GamesModule::startNewHangmanGame(uint32_t player, int difficulty)
+{
+    HangmanGame game = {};
+    seedGame(game.rng, GameKind::Hangman, player);
+    std::string_view word = getRandomWord(game.rng, difficulty);
+    game.length = std::min<size_t>(word.size(), HANGMAN_MAX_WORD_LEN);
+    memcpy(game.word, word.data(), game.length);
     game.player = player;
     game.remainingGuesses = 6;  // Standard hangman rules
-    game.guessedLetters = "";
-    game.currentState = std::string(game.word.length(), '_');
-    game.wasUpdated = time(nullptr);
+
+    // Where each letter occurs, so a guess never scans the word
+    for (int i = 0; i < game.length; i++) {
+        char c = game.word[i];
+        if (c >= 'A' && c <= 'Z')
+            game.letterPositions[c - 'A'] |= 1u << i;
+        else
+            game.revealedMask |= 1u << i;  // Nothing to guess
+    }
     activeHangmanGames[player] = game;
+    touchGame(GameKind::Hangman, player, activeHangmanGames[player]);
+    setSession(player, GameKind::Hangman, player);
 }
 
-std::string GamesModule::getHangmanStateString(const HangmanGame &game)
+void GamesModule::writeHangmanState(ReplyWriter &out, const HangmanGame &game)
 {
-    std::stringstream ss;
-    ss << "\nWord: ";
-    for (char c : game.currentState) {
-        ss << c << " ";
-    }
-    ss << "\nGuessed letters: " << (game.guessedLetters.empty() ? "none" : game.guessedLetters);
-    ss << "\nRemaining guesses: " << game.remainingGuesses;
-    return ss.str();
+    out << "\nWord: ";
+    for (int i = 0; i < game.length; i++) {
+        out << game.letterAt(i) << ' ';
+    }
+    out << "\nGuessed letters: ";
+    if (game.guessedMask == 0)
+        out << "none";
+    for (int letter = 0; letter < 26; letter++) {
+        if (game.guessedMask & (1u << letter))
+            out << char('A' + letter);
+    }
+    out << "\nRemaining guesses: " << game.remainingGuesses;
 }
 
 bool GamesModule::checkHangmanWin(const HangmanGame &game)
 {
-    return game.currentState.find('_') == std::string::npos;
+    return game.revealedMask == game.fullMask();
 }
 
 bool GamesModule::makeHangmanGuess(const meshtastic_MeshPacket &mp, char guess)
@@ -515,225 +1745,207 @@ bool GamesModule::makeHangmanGuess(const meshtastic_MeshPacket &mp, char guess)
         return false;
 
     // Convert guess to uppercase
-    guess = toupper(guess);
+    int letter = toupper(guess) - 'A';
+    uint32_t letterBit = 1u << letter;
 
     // Check if letter was already guessed
-    if (game.guessedLetters.find(guess) != std::string::npos) {
-        auto reply = allocReply();
-        std::string msg = "You already guessed that letter!" + getHangmanStateString(game);
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    if (game.guessedMask & letterBit) {
+        if (sendHangmanBinary(mp.from, game, BinaryStatus::AlreadyGuessed, GameKind::None))
+            return true;
+
+        ReplyWriter out = replyWriter();
+        out << "You already guessed that letter!";
+        writeHangmanState(out, game);
+        sendReply(mp.from, out);
         return true;
     }
 
     // Update game state
-    game.wasUpdated = time(nullptr);
-    game.guessedLetters += guess;
-
-    bool correctGuess = false;
-    for (size_t i = 0; i < game.word.length(); i++) {
-        if (game.word[i] == guess) {
-            game.currentState[i] = guess;
-            correctGuess = true;
-        }
-    }
+    touchGame(GameKind::Hangman, mp.from, game);
+    game.guessedMask |= letterBit;
+    game.revealedMask |= game.letterPositions[letter];
 
-    if (!correctGuess) {
+    if (!game.letterPositions[letter]) {
         game.remainingGuesses--;
     }
 
     // Check game end conditions
-    bool gameEnded = false;
-    std::string endMessage;
-
+    const char *endMessage = nullptr;
+    BinaryStatus status = BinaryStatus::Playing;
     if (checkHangmanWin(game)) {
-        endMessage = "\nCongratulations! You won! The word was: " + game.word;
-        gameEnded = true;
+        endMessage = "\nCongratulations! You won! The word was: ";
+        status = BinaryStatus::Won;
     }
     else if (game.remainingGuesses <= 0) {
-        endMessage = "\nGame Over! You lost. The word was: " + game.word;
-        gameEnded = true;
+        endMessage = "\nGame Over! You lost. The word was: ";
+        status = BinaryStatus::Lost;
     }
 
     // Send response to player
-    auto reply = allocReply();
-    std::string msg = getHangmanStateString(game);
-    if (gameEnded) {
-        msg += endMessage;
+    GameKind stateOf = endMessage ? GameKind::None : GameKind::Hangman;
+    if (!sendHangmanBinary(mp.from, game, status, stateOf)) {
+        ReplyWriter out = replyWriter();
+        writeHangmanState(out, game);
+        if (endMessage) {
+            out << endMessage << game.word;
+        }
+        else {
+            out << "\nMake your next guess!";
+        }
+        sendReply(mp.from, out, ReplyPriority::Direct, stateOf);
+    }
+
+    if (endMessage) {
+        clearSession(mp.from, GameKind::Hangman);
+        gameTimers.cancel(game.timer);
         activeHangmanGames.erase(it);
     }
-    else {
-        msg += "\nMake your next guess!";
+
+    return true;
+}
+
+bool GamesModule::cmdHangmanNew(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Check if player already has an active game
+    if (activeHangmanGames.find(mp.from) != activeHangmanGames.end()) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    // Optional difficulty, any word if none is given
+    int difficulty = -1;
+    for (int i = 0; i < 3; i++) {
+        if (HANGMAN_LEVELS[i] == args.word)
+            difficulty = i;
+    }
+    if (difficulty < 0 && !args.word.empty()) {
+        const char *msg = "Usage: h new [easy|medium|hard]";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    // Start a new game
+    startNewHangmanGame(mp.from, difficulty);
+    if (sendHangmanBinary(mp.from, activeHangmanGames[mp.from], BinaryStatus::Playing, GameKind::Hangman))
+        return true;
+
+    ReplyWriter out = replyWriter();
+    out << "New Hangman game started!";
+    writeHangmanState(out, activeHangmanGames[mp.from]);
+    out << "\nGuess a letter by typing it!";
+    sendReply(mp.from, out);
+    return true;
+}
+
+bool GamesModule::cmdHangmanState(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Show current game state
+    auto it = activeHangmanGames.find(mp.from);
+    if (it == activeHangmanGames.end()) {
+        const char *msg = "You don't have an active game. Start one with 'hangman new'";
+        sendReply(mp.from, msg);
+        return true;
     }
-    reply->decoded.payload.size = msg.length();
-    memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-    reply->to = mp.from;
-    service->sendToMesh(reply);
 
+    if (sendCachedView(mp.from, GameKind::Hangman, it->second.version))
+        return true;
+
+    ReplyWriter out = replyWriter();
+    if (isBinaryClient(mp.from)) {
+        writeHangmanBinary(out, it->second, BinaryStatus::Playing);
+    } else {
+        out << "Current game state:";
+        writeHangmanState(out, it->second);
+    }
+    sendView(mp.from, GameKind::Hangman, it->second.version, out);
     return true;
 }
 
-bool GamesModule::handleHangmanCommand(const meshtastic_MeshPacket &mp, const char *command)
+bool GamesModule::cmdHangmanGuess(const meshtastic_MeshPacket &mp, const CommandArgs &args)
 {
-    if (strncmp(command, "new", 3) == 0) {
-        // Check if player already has an active game
-        if (activeHangmanGames.find(mp.from) != activeHangmanGames.end()) {
-            auto reply = allocReply();
-            const char *msg = "You already have an active game!";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
-        }
+    if (!isalpha(static_cast<unsigned char>(args.letter)))
+        return false;
 
-        // Start a new game
-        startNewHangmanGame(mp.from);
-        auto reply = allocReply();
-        std::string msg = "New Hangman game started!" + getHangmanStateString(activeHangmanGames[mp.from]) + 
-                         "\nGuess a letter by typing it!";
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
-        return true;
-    }
-    else if (strncmp(command, "state", 5) == 0) {
-        // Show current game state
-        auto it = activeHangmanGames.find(mp.from);
-        if (it == activeHangmanGames.end()) {
-            auto reply = allocReply();
-            const char *msg = "You don't have an active game. Start one with 'hangman new'";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
-        }
+    // Make a guess
+    return makeHangmanGuess(mp, args.letter);
+}
 
-        auto reply = allocReply();
-        std::string msg = "Current game state:" + getHangmanStateString(it->second);
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+bool GamesModule::cmdRPSNew(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Check if player already has an active game
+    if (findRPSGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
         return true;
     }
-    else if (strlen(command) == 1 && isalpha(command[0])) {
-        // Make a guess
-        return makeHangmanGuess(mp, command[0]);
-    }
 
-    return false;
+    // Start a new game
+    startNewRPSGame(mp.from, 0);
+    rpsLobby.push(activeRPSGames[mp.from].lobby, mp.from, hopsAway(mp));
+    const char *msg = "New Rock Paper Scissors game started! Waiting for an opponent to join...\n"
+                     "Use 'rps join' to join this game or 'rps bot' to play against a bot.";
+    sendReply(mp.from, msg);
+    return true;
 }
 
-bool GamesModule::handleRPSCommand(const meshtastic_MeshPacket &mp, const char *command)
+bool GamesModule::cmdRPSBot(const meshtastic_MeshPacket &mp, const CommandArgs &)
 {
-    if (strncmp(command, "new", 3) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeRPSGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
-
-        // Start a new game
-        startNewRPSGame(mp.from, 0);
-        auto reply = allocReply();
-        const char *msg = "New Rock Paper Scissors game started! Waiting for an opponent to join...\n"
-                         "Use 'rps join' to join this game or 'rps bot' to play against a bot.";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    // Check if player already has an active game
+    if (findRPSGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
         return true;
     }
-    else if (strncmp(command, "bot", 3) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeRPSGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
 
-        // Start a new game against bot
-        startNewRPSGame(mp.from, 0, true);
-        auto reply = allocReply();
-        const char *msg = "New Rock Paper Scissors game started against a bot!\n"
-                         "Choose Rock(R), Paper(P), or Scissors(S)";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    // Start a new game against bot
+    startNewRPSGame(mp.from, 0, true);
+    const char *msg = "New Rock Paper Scissors game started against a bot!\n"
+                     "Choose Rock(R), Paper(P), or Scissors(S)";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+bool GamesModule::cmdRPSJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Check if player already has an active game
+    if (findRPSGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
         return true;
     }
-    else if (strncmp(command, "join", 4) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeRPSGames) {
-            if (game.second.player1 == mp.from || game.second.player2 == mp.from) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
 
-        // Find an available game
-        for (auto &game : activeRPSGames) {
-            if (game.second.player2 == 0 && game.second.player1 != mp.from && !game.second.isBotGame) {
-                game.second.player2 = mp.from;
-                game.second.wasUpdated = time(nullptr);
-
-                // Notify both players
-                auto reply = allocReply();
-                const char *msg = "Game started! Choose Rock(R), Paper(P), or Scissors(S)";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-
-                auto reply2 = allocDataPacket();
-                const char *msg2 = "Opponent joined! Choose Rock(R), Paper(P), or Scissors(S)";
-                reply2->decoded.payload.size = strlen(msg2);
-                memcpy(reply2->decoded.payload.bytes, msg2, reply2->decoded.payload.size);
-                reply2->to = game.second.player1;
-                service->sendToMesh(reply2);
+    // Take the oldest open game (bot games are never queued)
+    if (LobbyLink *open = rpsLobby.front(hopFilter(args))) {
+        uint32_t gameId = open->gameId;
+        rpsLobby.remove(*open);
+        auto &game = activeRPSGames[gameId];
+        game.player2 = mp.from;
+        touchGame(GameKind::RPS, gameId, game);
+        setSession(mp.from, GameKind::RPS, gameId);
 
-                return true;
-            }
-        }
+        // Notify both players
+        const char *msg = "Game started! Choose Rock(R), Paper(P), or Scissors(S)";
+        sendReply(mp.from, msg);
+
+        const char *msg2 = "Opponent joined! Choose Rock(R), Paper(P), or Scissors(S)";
+        sendReply(game.player1, msg2, ReplyPriority::Turn);
 
-        // No available games found
-        auto reply = allocReply();
-        const char *msg = "No games available to join. Start a new game with 'rps new' or play against a bot with 'rps bot'";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
         return true;
     }
-    else if (strlen(command) == 1 && (command[0] == 'R' || command[0] == 'P' || command[0] == 'S')) {
-        return makeRPSChoice(mp, command[0]);
-    }
 
-    return false;
+    // No available games found
+    const char *msg = "No games available to join. Start a new game with 'rps new' or play against a bot with 'rps bot'";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+bool GamesModule::cmdRPSChoice(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    if (args.letter != 'R' && args.letter != 'P' && args.letter != 'S')
+        return false;
+
+    return makeRPSChoice(mp, args.letter);
 }
 
 void GamesModule::startNewRPSGame(uint32_t player1, uint32_t player2, bool isBotGame)
@@ -746,92 +1958,81 @@ void GamesModule::startNewRPSGame(uint32_t player1, uint32_t player2, bool isBot
     game.player1Ready = false;
     game.player2Ready = false;
     game.isBotGame = isBotGame;
-    game.wasUpdated = time(nullptr);
+    seedGame(game.rng, GameKind::RPS, player1);
     activeRPSGames[player1] = game;
+    touchGame(GameKind::RPS, player1, activeRPSGames[player1]);
+    setSession(player1, GameKind::RPS, player1);
+    setSession(player2, GameKind::RPS, player1);
 }
 
-char GamesModule::getBotChoice()
+char GamesModule::getBotChoice(GamesRandom &rng)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 2);
-    
     const char choices[] = {'R', 'P', 'S'};
-    return choices[dis(gen)];
+    return choices[rng.below(3)];
 }
 
 bool GamesModule::makeRPSChoice(const meshtastic_MeshPacket &mp, char choice)
 {
-    for (auto it = activeRPSGames.begin(); it != activeRPSGames.end(); ++it) {
+    auto it = activeRPSGames.find(findSession(mp.from, GameKind::RPS));
+    if (it != activeRPSGames.end()) {
         auto &game = it->second;
         if (game.player1 == mp.from) {
             if (game.player1Ready) {
-                auto reply = allocReply();
                 const char *msg = "You've already made your choice!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
+                sendReply(mp.from, msg);
                 return true;
             }
             game.player1Choice = choice;
             game.player1Ready = true;
-            game.wasUpdated = time(nullptr);
+            touchGame(GameKind::RPS, it->first, game);
 
             // If it's a bot game, make the bot's choice immediately
             if (game.isBotGame) {
-                game.player2Choice = getBotChoice();
+                game.player2Choice = getBotChoice(game.rng);
                 game.player2Ready = true;
             }
         }
         else if (game.player2 == mp.from) {
             if (game.player2Ready) {
-                auto reply = allocReply();
                 const char *msg = "You've already made your choice!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
+                sendReply(mp.from, msg);
                 return true;
             }
             game.player2Choice = choice;
             game.player2Ready = true;
-            game.wasUpdated = time(nullptr);
+            touchGame(GameKind::RPS, it->first, game);
         }
         else {
-            continue;
+            return false;
         }
 
         // If both players have made their choices, determine the winner
         if (game.player1Ready && game.player2Ready) {
-            std::string result = getRPSResult(game);
-            
             // Notify both players
-            auto reply = allocDataPacket();
-            reply->decoded.payload.size = result.length();
-            memcpy(reply->decoded.payload.bytes, result.c_str(), reply->decoded.payload.size);
-            reply->to = game.player1;
-            service->sendToMesh(reply);
-
-            if (!game.isBotGame) {
-                auto reply2 = allocDataPacket();
-                reply2->decoded.payload.size = result.length();
-                memcpy(reply2->decoded.payload.bytes, result.c_str(), reply2->decoded.payload.size);
-                reply2->to = game.player2;
-                service->sendToMesh(reply2);
+            ReplyPriority priority1 = game.player1 == mp.from ? ReplyPriority::Direct : ReplyPriority::Turn;
+            ReplyPriority priority2 = game.player2 == mp.from ? ReplyPriority::Direct : ReplyPriority::Turn;
+            bool binary1 = sendRPSBinary(game.player1, game, priority1);
+            bool binary2 = game.isBotGame || sendRPSBinary(game.player2, game, priority2);
+            if (!binary1 || !binary2) {
+                ReplyWriter out = replyWriter();
+                writeRPSResult(out, game);
+                if (!binary1)
+                    sendReply(game.player1, out, priority1);
+                if (!binary2)
+                    sendReply(game.player2, out, priority2);
             }
 
             // Remove the game
+            clearSession(game.player1, GameKind::RPS);
+            clearSession(game.player2, GameKind::RPS);
+            rpsLobby.remove(game.lobby);
+            gameTimers.cancel(game.timer);
             activeRPSGames.erase(it);
         }
         else {
             // Notify the player who just made their choice
-            auto reply = allocReply();
             const char *msg = "Choice recorded! Waiting for opponent...";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
+            sendReply(mp.from, msg);
         }
         return true;
     }
@@ -839,302 +2040,275 @@ bool GamesModule::makeRPSChoice(const meshtastic_MeshPacket &mp, char choice)
     return false;
 }
 
-std::string GamesModule::getRPSResult(const RPSGame &game)
+void GamesModule::writeRPSResult(ReplyWriter &out, const RPSGame &game)
 {
-    std::stringstream ss;
-    ss << "Game Results:\n";
-    ss << "Player 1 chose: " << game.player1Choice << "\n";
+    out << "Game Results:\n";
+    out << "Player 1 chose: " << game.player1Choice << "\n";
     if (game.isBotGame) {
-        ss << "Bot chose: " << game.player2Choice << "\n\n";
+        out << "Bot chose: " << game.player2Choice << "\n\n";
     } else {
-        ss << "Player 2 chose: " << game.player2Choice << "\n\n";
+        out << "Player 2 chose: " << game.player2Choice << "\n\n";
     }
 
     if (game.player1Choice == game.player2Choice) {
-        ss << "It's a tie!";
+        out << "It's a tie!";
     }
     else if ((game.player1Choice == 'R' && game.player2Choice == 'S') ||
              (game.player1Choice == 'P' && game.player2Choice == 'R') ||
              (game.player1Choice == 'S' && game.player2Choice == 'P')) {
-        ss << "Player 1 wins!";
+        out << "Player 1 wins!";
     }
     else {
         if (game.isBotGame) {
-            ss << "Bot wins!";
+            out << "Bot wins!";
         } else {
-            ss << "Player 2 wins!";
+            out << "Player 2 wins!";
         }
     }
-
-    return ss.str();
 }
 
 void GamesModule::cleanupRPSGame(uint32_t gameId)
 {
-    auto &game = activeRPSGames[gameId];
-    std::string msg = "Rock Paper Scissors game timed out due to inactivity.";
+    auto it = activeRPSGames.find(gameId);
+    if (it == activeRPSGames.end())
+        return;
+
+    auto &game = it->second;
+    const char *msg = "Rock Paper Scissors game timed out due to inactivity.";
     
     if (game.player1 != 0) {
-        auto reply = allocDataPacket();
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = game.player1;
-        service->sendToMesh(reply);
+        sendReply(game.player1, msg, ReplyPriority::Broadcast);
     }
     
     if (game.player2 != 0) {
-        auto reply = allocDataPacket();
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = game.player2;
-        service->sendToMesh(reply);
+        sendReply(game.player2, msg, ReplyPriority::Broadcast);
     }
     
-    activeRPSGames.erase(gameId);
+    clearSession(game.player1, GameKind::RPS);
+    clearSession(game.player2, GameKind::RPS);
+    rpsLobby.remove(game.lobby);
+    gameTimers.cancel(game.timer);
+    activeRPSGames.erase(it);
 }
 
 // Auto Chess game implementation
-bool GamesModule::handleAutoChessCommand(const meshtastic_MeshPacket &mp, const char *command)
-{
-    if (strncmp(command, "new", 3) == 0) {
-        // Check if player already has an active game
-        for (const auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                auto reply = allocReply();
-                const char *msg = "You already have an active game!";
-                reply->decoded.payload.size = strlen(msg);
-                memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
+bool GamesModule::cmdAutoChessNew(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Check if player already has an active game
+    if (findAutoChessGame(mp.from)) {
+        const char *msg = "You already have an active game!";
+        sendReply(mp.from, msg);
+        return true;
+    }
 
-        // Start a new game
-        startNewAutoChessGame(mp.from);
-        auto reply = allocReply();
-        std::string msg = "New Auto Chess game started! Waiting for players (2-4 players needed)\n" + 
-                         getAutoChessStateString(activeAutoChessGames[mp.from].players[mp.from]);
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    // Start a new game
+    startNewAutoChessGame(mp.from);
+    autoChessLobby.push(activeAutoChessGames[mp.from].lobby, mp.from, hopsAway(mp));
+    sendAutoChessUpdate(mp.from, activeAutoChessGames[mp.from].players[mp.from], AutoChessEvent::NewGame, true);
+    return true;
+}
+
+bool GamesModule::cmdAutoChessStatus(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Find player's active game
+    uint32_t gameId = findSession(mp.from, GameKind::AutoChess);
+    if (const AutoChessGame *game = findAutoChessGame(mp.from)) {
+        ReplyWriter out = replyWriter();
+        out << "Game Status:\n"
+            << "Players: " << game->players.size() << "/4\n"
+            << "Game ID: " << gameId << "\n"
+            << "Status: " << (game->isActive ? "Active" : "Waiting for players") << "\n"
+            << "Round: " << game->round << "\n";
+        sendReply(mp.from, out);
         return true;
     }
-    else if (strncmp(command, "status", 6) == 0) {
-        // Find player's active game
-        for (const auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                auto reply = allocReply();
-                std::string msg = "Game Status:\n";
-                msg += "Players: " + std::to_string(game.second.players.size()) + "/4\n";
-                msg += "Game ID: " + std::to_string(game.first) + "\n";
-                msg += "Status: " + std::string(game.second.isActive ? "Active" : "Waiting for players") + "\n";
-                msg += "Round: " + std::to_string(game.second.round) + "\n";
-                reply->decoded.payload.size = msg.length();
-                memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
+
+    const char *msg = "You don't have an active game. Start one with 'ac new' or join one with 'ac join <game_id>'";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+// Arguments are parsed as int64_t; true if value is in [0, limit) and so
+// survives narrowing to the handler's type
+static bool argInRange(int64_t value, int64_t limit)
+{
+    return value >= 0 && value < limit;
+}
+
+bool GamesModule::cmdAutoChessJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Without a game ID, join the oldest game that still has free seats
+    uint32_t gameId = 0;
+    if (args.count > 0) {
+        if (!argInRange(args.values[0], int64_t(UINT32_MAX) + 1)) {
+            sendReply(mp.from, findCommand(GameKind::AutoChess, "join")->usageError);
+            return true;
         }
+        gameId = static_cast<uint32_t>(args.values[0]);
+    } else if (LobbyLink *open = autoChessLobby.front()) {
+        gameId = open->gameId;
+    }
 
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game. Start one with 'ac new' or join one with 'ac join <game_id>'";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    if (joinAutoChessGame(mp.from, gameId)) {
+        sendAutoChessUpdate(mp.from, activeAutoChessGames[gameId].players[mp.from], AutoChessEvent::Joined, true);
+        return true;
+    }
+    else {
+        const char *msg = "Failed to join game. Game might be full or doesn't exist.";
+        sendReply(mp.from, msg);
         return true;
     }
-    else if (strncmp(command, "join", 4) == 0) {
-        // Parse game ID from command
-        uint32_t gameId;
-        if (sscanf(command + 5, "%u", &gameId) != 1) {
-            auto reply = allocReply();
-            const char *msg = "Invalid game ID. Usage: ac join <game_id>";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
+}
+
+bool GamesModule::cmdAutoChessLog(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // Without a round, show the latest battle
+    int round = 0;
+    if (args.count > 0) {
+        if (!argInRange(args.values[0], UINT16_MAX + 1)) {
+            sendReply(mp.from, findCommand(GameKind::AutoChess, "log")->usageError);
             return true;
         }
+        round = static_cast<int>(args.values[0]);
+    }
 
-        if (joinAutoChessGame(mp.from, gameId)) {
-            auto reply = allocReply();
-            std::string msg = "Joined Auto Chess game!\n" + getAutoChessStateString(activeAutoChessGames[gameId].players[mp.from]);
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
+    const BattleLog *log = findBattleLog(mp.from, round);
+    if (!log) {
+        const char *msg = "No recent battle to show.";
+        sendReply(mp.from, msg);
+        return true;
+    }
+
+    uint8_t encoded[BATTLE_LOG_MAX_ENCODED + 1];
+    encoded[0] = static_cast<uint8_t>(BinaryReply::BattleLog);
+    size_t len = encodeBattleLog(*log, encoded + 1, BATTLE_LOG_MAX_ENCODED);
+    if (isBinaryClient(mp.from)) {
+        sendBinary(mp.from, reinterpret_cast<const char *>(encoded), len + 1, ReplyPriority::Direct, GameKind::None);
+        return true;
+    }
+
+    // Hex in short lines, so fragments only break between lines; tools/battle_replay
+    // joins the lines back up
+    static const char HEX[] = "0123456789abcdef";
+    ReplyWriter out = replyWriter();
+    out << "Round " << log->round << " battle log:";
+    for (size_t i = 1; i <= len; i++) {
+        if ((i - 1) % BATTLE_LOG_HEX_LINE_BYTES == 0)
+            out << '\n';
+        out << HEX[encoded[i] >> 4] << HEX[encoded[i] & 0xF];
+    }
+    sendReply(mp.from, out);
+    return true;
+}
+
+// The player's battle in the given round of their game, or their latest one
+// when round is 0. Only the last AUTOCHESS_LOG_ROUNDS rounds are kept.
+const BattleLog *GamesModule::findBattleLog(uint32_t player, int round)
+{
+    AutoChessGame *game = findAutoChessGame(player);
+    if (!game)
+        return nullptr;
+    for (uint8_t i = 1; i <= game->battleLogCount; i++) {
+        size_t slot = (game->battleLogNext + AUTOCHESS_BATTLE_LOGS - i) % AUTOCHESS_BATTLE_LOGS;
+        const BattleLog &log = game->battleLogs[slot];
+        if ((log.players[0] == player || log.players[1] == player) && (round == 0 || log.round == round))
+            return &log;
+    }
+    return nullptr;
+}
+
+bool GamesModule::cmdAutoChessState(const meshtastic_MeshPacket &mp, const CommandArgs &)
+{
+    // Find player's active game
+    if (AutoChessGame *game = findAutoChessGame(mp.from)) {
+        if (!sendCachedView(mp.from, GameKind::AutoChess, game->version))
+            sendAutoChessUpdate(mp.from, game->players.at(mp.from), AutoChessEvent::State, true);
+        return true;
+    }
+
+    const char *msg = "You don't have an active game. Start one with 'ac new' or join one with 'ac join <game_id>'";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+bool GamesModule::cmdAutoChessBuy(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    if (!argInRange(args.values[0], AUTOCHESS_SHOP_SIZE)) {
+        sendReply(mp.from, findCommand(GameKind::AutoChess, "buy")->usageError);
+        return true;
+    }
+    int unitIndex = static_cast<int>(args.values[0]);
+
+    // Find player's active game
+    if (AutoChessGame *game = findAutoChessGame(mp.from)) {
+        if (buyUnit(game->players[mp.from], unitIndex)) {
+            touchGame(GameKind::AutoChess, findSession(mp.from, GameKind::AutoChess), *game);
+            sendAutoChessUpdate(mp.from, game->players[mp.from], AutoChessEvent::Purchased, false);
         }
         else {
-            auto reply = allocReply();
-            const char *msg = "Failed to join game. Game might be full or doesn't exist.";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
+            const char *msg = "Failed to buy unit. Not enough gold or invalid unit index.";
+            sendReply(mp.from, msg);
         }
+        return true;
     }
-    else if (strncmp(command, "state", 5) == 0) {
-        // Find player's active game
-        for (const auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                auto reply = allocReply();
-                std::string msg = "Current game state:\n" + getAutoChessStateString(game.second.players.at(mp.from));
-                reply->decoded.payload.size = msg.length();
-                memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                reply->to = mp.from;
-                service->sendToMesh(reply);
-                return true;
-            }
-        }
 
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game. Start one with 'ac new' or join one with 'ac join <game_id>'";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+    const char *msg = "You don't have an active game.";
+    sendReply(mp.from, msg);
+    return true;
+}
+
+bool GamesModule::cmdAutoChessSell(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    // The bench has no fixed size; sellUnit checks the index against it
+    if (!argInRange(args.values[0], INT32_MAX)) {
+        sendReply(mp.from, findCommand(GameKind::AutoChess, "sell")->usageError);
         return true;
     }
-    else if (strncmp(command, "buy", 3) == 0) {
-        // Parse unit index from command
-        int unitIndex;
-        if (sscanf(command + 4, "%d", &unitIndex) != 1) {
-            auto reply = allocReply();
-            const char *msg = "Invalid unit index. Usage: ac buy <unit_index>";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
-        }
+    int unitIndex = static_cast<int>(args.values[0]);
 
-        // Find player's active game
-        for (auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                if (buyUnit(game.second.players[mp.from], unitIndex)) {
-                    auto reply = allocReply();
-                    std::string msg = "Unit purchased!\n" + getAutoChessStateString(game.second.players[mp.from]);
-                    reply->decoded.payload.size = msg.length();
-                    memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                else {
-                    auto reply = allocReply();
-                    const char *msg = "Failed to buy unit. Not enough gold or invalid unit index.";
-                    reply->decoded.payload.size = strlen(msg);
-                    memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                return true;
-            }
+    // Find player's active game
+    if (AutoChessGame *game = findAutoChessGame(mp.from)) {
+        if (sellUnit(game->players[mp.from], unitIndex)) {
+            touchGame(GameKind::AutoChess, findSession(mp.from, GameKind::AutoChess), *game);
+            sendAutoChessUpdate(mp.from, game->players[mp.from], AutoChessEvent::Sold, false);
+        }
+        else {
+            const char *msg = "Failed to sell unit. Invalid unit index.";
+            sendReply(mp.from, msg);
         }
-
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game.";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
         return true;
     }
-    else if (strncmp(command, "sell", 4) == 0) {
-        // Parse unit index from command
-        int unitIndex;
-        if (sscanf(command + 5, "%d", &unitIndex) != 1) {
-            auto reply = allocReply();
-            const char *msg = "Invalid unit index. Usage: ac sell <unit_index>";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
-        }
 
-        // Find player's active game
-        for (auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                if (sellUnit(game.second.players[mp.from], unitIndex)) {
-                    auto reply = allocReply();
-                    std::string msg = "Unit sold!\n" + getAutoChessStateString(game.second.players[mp.from]);
-                    reply->decoded.payload.size = msg.length();
-                    memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                else {
-                    auto reply = allocReply();
-                    const char *msg = "Failed to sell unit. Invalid unit index.";
-                    reply->decoded.payload.size = strlen(msg);
-                    memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                return true;
-            }
-        }
+    const char *msg = "You don't have an active game.";
+    sendReply(mp.from, msg);
+    return true;
+}
 
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game.";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
+bool GamesModule::cmdAutoChessPlace(const meshtastic_MeshPacket &mp, const CommandArgs &args)
+{
+    if (!argInRange(args.values[0], INT32_MAX) || !argInRange(args.values[1], BATTLE_MAX_UNITS)) {
+        sendReply(mp.from, findCommand(GameKind::AutoChess, "place")->usageError);
         return true;
     }
-    else if (strncmp(command, "place", 5) == 0) {
-        // Parse bench and board indices from command
-        int benchIndex, boardIndex;
-        if (sscanf(command + 6, "%d %d", &benchIndex, &boardIndex) != 2) {
-            auto reply = allocReply();
-            const char *msg = "Invalid indices. Usage: ac place <bench_index> <board_index>";
-            reply->decoded.payload.size = strlen(msg);
-            memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-            reply->to = mp.from;
-            service->sendToMesh(reply);
-            return true;
-        }
+    int benchIndex = static_cast<int>(args.values[0]);
+    int boardIndex = static_cast<int>(args.values[1]);
 
-        // Find player's active game
-        for (auto &game : activeAutoChessGames) {
-            if (game.second.players.find(mp.from) != game.second.players.end()) {
-                if (placeUnit(game.second.players[mp.from], benchIndex, boardIndex)) {
-                    auto reply = allocReply();
-                    std::string msg = "Unit placed!\n" + getAutoChessStateString(game.second.players[mp.from]);
-                    reply->decoded.payload.size = msg.length();
-                    memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                else {
-                    auto reply = allocReply();
-                    const char *msg = "Failed to place unit. Invalid indices or board is full.";
-                    reply->decoded.payload.size = strlen(msg);
-                    memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-                    reply->to = mp.from;
-                    service->sendToMesh(reply);
-                }
-                return true;
-            }
+    // Find player's active game
+    if (AutoChessGame *game = findAutoChessGame(mp.from)) {
+        if (placeUnit(game->players[mp.from], benchIndex, boardIndex)) {
+            touchGame(GameKind::AutoChess, findSession(mp.from, GameKind::AutoChess), *game);
+            sendAutoChessUpdate(mp.from, game->players[mp.from], AutoChessEvent::Placed, false);
+        }
+        else {
+            const char *msg = "Failed to place unit. Invalid indices or board is full.";
+            sendReply(mp.from, msg);
         }
-
-        auto reply = allocReply();
-        const char *msg = "You don't have an active game.";
-        reply->decoded.payload.size = strlen(msg);
-        memcpy(reply->decoded.payload.bytes, msg, reply->decoded.payload.size);
-        reply->to = mp.from;
-        service->sendToMesh(reply);
         return true;
     }
 
-    return false;
+    const char *msg = "You don't have an active game.";
+    sendReply(mp.from, msg);
+    return true;
 }
 
 void GamesModule::startNewAutoChessGame(uint32_t player)
@@ -1142,7 +2316,10 @@ void GamesModule::startNewAutoChessGame(uint32_t player)
     AutoChessGame game;
     game.round = 1;
     game.isActive = false;  // Game starts inactive until enough players join
-    game.wasUpdated = time(nullptr);
+    game.wasUpdated = nowTick;
+    game.nextRoundTick = 0;
+    game.roundToken = 0;
+    seedGame(game.rng, GameKind::AutoChess, player);
 
     AutoChessPlayer newPlayer;
     newPlayer.playerId = player;
@@ -1150,13 +2327,15 @@ void GamesModule::startNewAutoChessGame(uint32_t player)
     newPlayer.level = 1;
     newPlayer.experience = 0;
     newPlayer.mana = 0;
-    newPlayer.wasUpdated = time(nullptr);
+    newPlayer.wasUpdated = nowTick;
     
     // Initialize shop
-    refreshShop(newPlayer);
+    refreshShop(newPlayer, game.rng);
 
     game.players[player] = newPlayer;
     activeAutoChessGames[player] = game;
+    setSession(player, GameKind::AutoChess, player);
+    touchGame(GameKind::AutoChess, player, activeAutoChessGames[player]);
 }
 
 bool GamesModule::joinAutoChessGame(uint32_t player, uint32_t gameId)
@@ -1166,11 +2345,11 @@ bool GamesModule::joinAutoChessGame(uint32_t player, uint32_t gameId)
         return false;
 
     // Check if game is full (max 4 players)
-    if (it->second.players.size() >= 4)
+    if (it->second.players.size() >= AUTOCHESS_MAX_PLAYERS)
         return false;
 
-    // Check if player is already in the game
-    if (it->second.players.find(player) != it->second.players.end())
+    // Check if player is already in this or another game
+    if (findSession(player, GameKind::AutoChess) != 0)
         return false;
 
     AutoChessPlayer newPlayer;
@@ -1179,25 +2358,27 @@ bool GamesModule::joinAutoChessGame(uint32_t player, uint32_t gameId)
     newPlayer.level = 1;
     newPlayer.experience = 0;
     newPlayer.mana = 0;
-    newPlayer.wasUpdated = time(nullptr);
+    newPlayer.wasUpdated = nowTick;
     
     // Initialize shop
-    refreshShop(newPlayer);
+    refreshShop(newPlayer, it->second.rng);
 
     it->second.players[player] = newPlayer;
-    it->second.wasUpdated = time(nullptr);
+    it->second.wasUpdated = nowTick;
+    setSession(player, GameKind::AutoChess, gameId);
+    touchGame(GameKind::AutoChess, gameId, it->second);
+    if (it->second.players.size() >= AUTOCHESS_MAX_PLAYERS)
+        autoChessLobby.remove(it->second.lobby);
 
     // Check if we have enough players to start (2-4 players)
     if (it->second.players.size() >= 2 && !it->second.isActive) {
         it->second.isActive = true;
+        scheduleRound(gameId, it->second, nowTick + BATTLE_INTERVAL_SECONDS);
         // Notify all players that the game is starting
-        std::string msg = "Game is starting with " + std::to_string(it->second.players.size()) + " players!";
+        ReplyWriter out = replyWriter();
+        out << "Game is starting with " << it->second.players.size() << " players!";
         for (const auto &p : it->second.players) {
-            auto reply = allocDataPacket();
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = p.first;
-            service->sendToMesh(reply);
+            sendReply(p.first, out, ReplyPriority::Broadcast);
         }
     }
 
@@ -1206,82 +2387,223 @@ bool GamesModule::joinAutoChessGame(uint32_t player, uint32_t gameId)
 
 void GamesModule::cleanupAutoChessGame(uint32_t gameId)
 {
-    auto &game = activeAutoChessGames[gameId];
-    std::string msg = "Auto Chess game timed out due to inactivity.";
+    auto it = activeAutoChessGames.find(gameId);
+    if (it == activeAutoChessGames.end())
+        return;
+
+    auto &game = it->second;
+    const char *msg = "Auto Chess game timed out due to inactivity.";
     
     for (const auto &player : game.players) {
-        auto reply = allocDataPacket();
-        reply->decoded.payload.size = msg.length();
-        memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-        reply->to = player.first;
-        service->sendToMesh(reply);
+        sendReply(player.first, msg, ReplyPriority::Broadcast);
+        clearSession(player.first, GameKind::AutoChess);
     }
     
-    activeAutoChessGames.erase(gameId);
+    autoChessLobby.remove(game.lobby);
+    gameTimers.cancel(game.timer);
+    activeAutoChessGames.erase(it);
 }
 
-std::string GamesModule::getAutoChessStateString(const AutoChessPlayer &player)
+void GamesModule::writeAutoChessState(ReplyWriter &out, const AutoChessPlayer &player)
 {
-    std::stringstream ss;
-    ss << "Level: " << player.level << " (XP: " << player.experience << ")\n";
-    ss << "Gold: " << player.gold << "\n";
-    ss << "Mana: " << player.mana << "\n";
+    out << "Level: " << player.level << " (XP: " << player.experience << ")\n";
+    out << "Gold: " << player.gold << "\n";
+    out << "Mana: " << player.mana << "\n";
     
     // Find the game this player is in
-    for (const auto &game : activeAutoChessGames) {
-        if (game.second.players.find(player.playerId) != game.second.players.end()) {
-            ss << "Players: " << game.second.players.size() << "/4\n";
-            ss << "Status: " << (game.second.isActive ? "Game in progress" : "Waiting for players (need 2-4)") << "\n";
-            break;
-        }
+    if (const AutoChessGame *game = findAutoChessGame(player.playerId)) {
+        out << "Players: " << game->players.size() << "/4\n";
+        out << "Status: " << (game->isActive ? "Game in progress" : "Waiting for players (need 2-4)") << "\n";
     }
     
-    ss << "\n" << getShopString(player) << "\n";
+    out << '\n';
+    writeShop(out, player);
+    out << '\n';
     
-    ss << "Bench:\n";
+    out << "Bench:\n";
     for (size_t i = 0; i < player.bench.size(); i++) {
         const auto &unit = player.bench[i];
-        ss << i << ". " << unit.name << " (" << unit.race << " " << unit.class_ << ")\n"
-           << "   Level: " << unit.level << ", Cost: " << unit.cost << "\n";
+        out << i << ". ";
+        writeUnitName(out, unit);
+        out << "   Level: " << unit.stars << ", Cost: " << templateOf(unit).cost << "\n";
     }
     
-    ss << "\nBoard:\n";
+    out << "\nBoard:\n";
     for (size_t i = 0; i < player.board.size(); i++) {
         const auto &unit = player.board[i];
-        ss << i << ". " << unit.name << " (" << unit.race << " " << unit.class_ << ")\n"
-           << "   Level: " << unit.level << "\n";
+        out << i << ". ";
+        writeUnitName(out, unit);
+        out << "   Level: " << unit.stars << "\n";
+    }
+}
+
+// Sends the player's state, as a delta against what they were last sent
+// unless a full resync is asked for or their view may be out of step.
+const char *const GamesModule::AUTOCHESS_EVENT_TEXT[] = {
+    "Current game state:",
+    "New Auto Chess game started! Waiting for players (2-4 players needed)",
+    "Joined Auto Chess game!",
+    "Unit purchased!",
+    "Unit sold!",
+    "Unit placed!",
+};
+
+void GamesModule::sendAutoChessUpdate(uint32_t playerId, AutoChessPlayer &player, AutoChessEvent event, bool fullSync)
+{
+    AutoChessView before = player.sent;
+    bool full = fullSync || !before.valid;
+    player.sent.sequence++;
+    bool tracked = snapshotAutoChessView(player.sent, player);
+
+    // The binary state is smaller than a text delta, so binary clients always get all of it
+    ReplyWriter out = replyWriter();
+    const AutoChessGame *game = findAutoChessGame(playerId);
+    if (tracked && isBinaryClient(playerId)) {
+        writeAutoChessBinary(out, player.sent, event, game ? game->players.size() : 0, game && game->isActive);
+        if (event == AutoChessEvent::State && game)
+            sendView(playerId, GameKind::AutoChess, game->version, out);
+        else
+            sendBinary(playerId, out.data(), out.size(), ReplyPriority::Direct, GameKind::AutoChess);
+        return;
+    }
+
+    const char *headline = AUTOCHESS_EVENT_TEXT[static_cast<size_t>(event)];
+    if (full || !tracked) {
+        out << headline << "\nSync #" << player.sent.sequence << '\n';
+        writeAutoChessState(out, player);
+        if (event == AutoChessEvent::State && game)
+            sendView(playerId, GameKind::AutoChess, game->version, out);
+        else
+            sendReply(playerId, out, ReplyPriority::Direct, GameKind::AutoChess);
+    } else {
+        out << headline << " #" << player.sent.sequence << '\n';
+        writeAutoChessDelta(out, before, player.sent);
+        sendReply(playerId, out, ReplyPriority::Direct, GameKind::AutoChess, false);
+    }
+}
+
+void GamesModule::writeAutoChessBinary(ReplyWriter &out, const AutoChessView &view, AutoChessEvent event,
+                                       size_t players, bool active)
+{
+    out << static_cast<char>(BinaryReply::AutoChess);
+    out.varint(static_cast<uint8_t>(event)).varint(view.sequence);
+    out.varint(view.level).varint(view.experience).varint(view.gold).varint(view.mana);
+    out.varint(players).varint(active ? 1 : 0);
+    writeUnitListBinary(out, view.shop);
+    writeUnitListBinary(out, view.bench);
+    writeUnitListBinary(out, view.board);
+}
+
+void GamesModule::writeUnitListBinary(ReplyWriter &out, const AutoChessView::UnitList &list)
+{
+    out.varint(list.count);
+    for (size_t i = 0; i < list.count; i++)
+        out.varint(list.units[i]);
+}
+
+bool GamesModule::snapshotAutoChessView(AutoChessView &view, const AutoChessPlayer &player)
+{
+    view.level = player.level;
+    view.experience = player.experience;
+    view.gold = player.gold;
+    view.mana = player.mana;
+    view.valid = fillUnitList(view.shop, player.shop.availableUnits) && fillUnitList(view.bench, player.bench) &&
+                 fillUnitList(view.board, player.board);
+    return view.valid;
+}
+
+bool GamesModule::fillUnitList(AutoChessView::UnitList &list, const std::vector<AutoChessUnit> &units)
+{
+    if (units.size() > AutoChessView::MAX_UNITS)
+        return false;
+    list.count = units.size();
+    for (size_t i = 0; i < units.size(); i++)
+        list.units[i] = units[i].templateId;
+    return true;
+}
+
+// Writes changes as "gold 12>9, bench +Knight, shop -2"
+void GamesModule::writeAutoChessDelta(ReplyWriter &out, const AutoChessView &before, const AutoChessView &after)
+{
+    bool first = true;
+    const char *labels[] = {"level", "xp", "gold", "mana"};
+    const int from[] = {before.level, before.experience, before.gold, before.mana};
+    const int to[] = {after.level, after.experience, after.gold, after.mana};
+    for (int i = 0; i < 4; i++) {
+        if (from[i] == to[i])
+            continue;
+        out << (first ? "" : ", ") << labels[i] << ' ' << from[i] << '>' << to[i];
+        first = false;
+    }
+    writeUnitListDelta(out, "shop", before.shop, after.shop, first);
+    writeUnitListDelta(out, "bench", before.bench, after.bench, first);
+    writeUnitListDelta(out, "board", before.board, after.board, first);
+    if (first)
+        out << "no changes";
+}
+
+// One unit removed at k is "-k", one appended is "+Name", anything else lists the whole row
+void GamesModule::writeUnitListDelta(ReplyWriter &out, const char *label, const AutoChessView::UnitList &before,
+                                     const AutoChessView::UnitList &after, bool &first)
+{
+    size_t prefix = 0;
+    while (prefix < before.count && prefix < after.count && before.units[prefix] == after.units[prefix])
+        prefix++;
+    if (prefix == before.count && prefix == after.count)
+        return;
+
+    out << (first ? "" : ", ") << label;
+    first = false;
+    if (after.count + 1 == before.count &&
+        memcmp(before.units + prefix + 1, after.units + prefix, after.count - prefix) == 0) {
+        out << " -" << prefix;
+    } else if (after.count == before.count + 1 && prefix == before.count) {
+        out << " +" << UNIT_TEMPLATES[after.units[prefix]].name;
+    } else {
+        out << ':';
+        for (size_t i = 0; i < after.count; i++)
+            out << (i ? "/" : " ") << UNIT_TEMPLATES[after.units[i]].name;
+        if (after.count == 0)
+            out << " empty";
     }
-    
-    return ss.str();
 }
 
-void GamesModule::refreshShop(AutoChessPlayer &player)
+void GamesModule::refreshShop(AutoChessPlayer &player, GamesRandom &rng)
 {
     player.shop.availableUnits.clear();
     
-    // Generate 5 random units from templates
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, UNIT_TEMPLATES_COUNT - 1);
-    
-    for (int i = 0; i < 5; i++) {
-        player.shop.availableUnits.push_back(UNIT_TEMPLATES[dis(gen)]);
+    // Generate random units from templates
+    for (size_t i = 0; i < AUTOCHESS_SHOP_SIZE; i++) {
+        player.shop.availableUnits.push_back(makeUnit(rng.below(UNIT_TEMPLATES_COUNT)));
     }
     
-    player.shop.lastRefresh = time(nullptr);
+    player.shop.lastRefresh = nowTick;
 }
 
-std::string GamesModule::getShopString(const AutoChessPlayer &player)
+void GamesModule::writeShop(ReplyWriter &out, const AutoChessPlayer &player)
 {
-    std::stringstream ss;
-    ss << "Shop:\n";
+    out << "Shop:\n";
     for (size_t i = 0; i < player.shop.availableUnits.size(); i++) {
         const auto &unit = player.shop.availableUnits[i];
-        ss << i << ". " << unit.name << " (" << unit.race << " " << unit.class_ << ")\n"
-           << "   Cost: " << unit.cost << " gold, Health: " << unit.health 
-           << ", Damage: " << unit.damage << ", Mana: " << unit.mana << "\n";
+        out << i << ". ";
+        writeUnitName(out, unit);
+        out << "   Cost: " << templateOf(unit).cost << " gold, Health: " << unit.health 
+            << ", Damage: " << templateOf(unit).damage << ", Mana: " << unit.mana << "\n";
     }
-    return ss.str();
+}
+
+AutoChessUnit GamesModule::makeUnit(uint8_t templateId)
+{
+    const auto &info = UNIT_TEMPLATES[templateId];
+    return {templateId, 1, info.health, info.mana};
+}
+
+// "Knight (Human Warrior)" and a newline
+void GamesModule::writeUnitName(ReplyWriter &out, const AutoChessUnit &unit)
+{
+    const auto &info = templateOf(unit);
+    out << info.name << " (" << UNIT_RACE_NAMES[static_cast<int>(info.race)] << " "
+        << UNIT_CLASS_NAMES[static_cast<int>(info.unitClass)] << ")\n";
 }
 
 bool GamesModule::buyUnit(AutoChessPlayer &player, int unitIndex)
@@ -1292,19 +2614,19 @@ bool GamesModule::buyUnit(AutoChessPlayer &player, int unitIndex)
     const auto &unit = player.shop.availableUnits[unitIndex];
     
     // Check if player has enough gold
-    if (player.gold < unit.cost)
+    if (player.gold < templateOf(unit).cost)
         return false;
         
     // Add unit to bench
     player.bench.push_back(unit);
     
     // Deduct gold
-    player.gold -= unit.cost;
+    player.gold -= templateOf(unit).cost;
     
     // Remove unit from shop
     player.shop.availableUnits.erase(player.shop.availableUnits.begin() + unitIndex);
     
-    player.wasUpdated = time(nullptr);
+    player.wasUpdated = nowTick;
     return true;
 }
 
@@ -1314,11 +2636,11 @@ bool GamesModule::sellUnit(AutoChessPlayer &player, int unitIndex)
         return false;
 
     // Add gold based on unit cost
-    player.gold += player.bench[unitIndex].cost;
+    player.gold += templateOf(player.bench[unitIndex]).cost;
     
     // Remove unit from bench
     player.bench.erase(player.bench.begin() + unitIndex);
-    player.wasUpdated = time(nullptr);
+    player.wasUpdated = nowTick;
     return true;
 }
 
@@ -1327,7 +2649,7 @@ bool GamesModule::placeUnit(AutoChessPlayer &player, int benchIndex, int boardIn
     if (benchIndex < 0 || benchIndex >= player.bench.size())
         return false;
     
-    if (boardIndex < 0 || boardIndex >= 9) // 3x3 board
+    if (boardIndex < 0 || boardIndex >= BATTLE_MAX_UNITS) // 3x3 board
         return false;
     
     // Check if board position is empty
@@ -1336,8 +2658,9 @@ bool GamesModule::placeUnit(AutoChessPlayer &player, int benchIndex, int boardIn
     
     // Move unit from bench to board
     player.board.push_back(player.bench[benchIndex]);
+    player.synergies.add(templateOf(player.board.back()));
     player.bench.erase(player.bench.begin() + benchIndex);
-    player.wasUpdated = time(nullptr);
+    player.wasUpdated = nowTick;
     return true;
 }
 
@@ -1345,7 +2668,7 @@ void GamesModule::processRound(AutoChessGame &game)
 {
     // Refresh shop for all players
     for (auto &player : game.players) {
-        refreshShop(player.second);
+        refreshShop(player.second, game.rng);
     }
     
     // Distribute gold and mana
@@ -1356,35 +2679,36 @@ void GamesModule::processRound(AutoChessGame &game)
     processBattles(game);
     
     game.round++;
-    game.wasUpdated = time(nullptr);
+    game.wasUpdated = nowTick;
+    game.version = ++stateVersion;
 }
 
 void GamesModule::processBattles(AutoChessGame &game)
 {
-    // Create a vector of player IDs for random matching
-    std::vector<uint32_t> playerIds;
+    // Player IDs for random matching
+    std::array<uint32_t, AUTOCHESS_MAX_PLAYERS> playerIds;
+    size_t playerCount = 0;
     for (const auto &player : game.players) {
-        playerIds.push_back(player.first);
+        if (playerCount < playerIds.size())
+            playerIds[playerCount++] = player.first;
     }
     
-    // Shuffle players for random matching
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::shuffle(playerIds.begin(), playerIds.end(), gen);
+    // Shuffle players for random matching (Fisher-Yates, so a seed gives
+    // the same pairings on every platform)
+    for (size_t i = playerCount; i > 1; i--) {
+        std::swap(playerIds[i - 1], playerIds[game.rng.below(i)]);
+    }
     
     // Process battles in pairs
-    for (size_t i = 0; i < playerIds.size(); i += 2) {
-        if (i + 1 < playerIds.size()) {
+    for (size_t i = 0; i < playerCount; i += 2) {
+        if (i + 1 < playerCount) {
             // Battle between two players
             processBattle(game, playerIds[i], playerIds[i + 1]);
         } else {
             // Odd number of players, last player gets a bye
-            auto reply = allocDataPacket();
-            std::string msg = "Round " + std::to_string(game.round) + ": You received a bye this round.";
-            reply->decoded.payload.size = msg.length();
-            memcpy(reply->decoded.payload.bytes, msg.c_str(), reply->decoded.payload.size);
-            reply->to = playerIds[i];
-            service->sendToMesh(reply);
+            ReplyWriter out = replyWriter();
+            out << "Round " << game.round << ": You received a bye this round.";
+            sendReply(playerIds[i], out, ReplyPriority::Broadcast);
         }
     }
 }
@@ -1394,150 +2718,39 @@ void GamesModule::processBattle(AutoChessGame &game, uint32_t player1Id, uint32_
     auto &player1 = game.players[player1Id];
     auto &player2 = game.players[player2Id];
     
-    // Calculate synergies
-    int player1Warriors = countWarriors(player1);
-    int player2Warriors = countWarriors(player2);
-    int player1Trolls = countTrolls(player1);
-    int player2Trolls = countTrolls(player2);
-    int player1Elves = countElves(player1);
-    int player2Elves = countElves(player2);
-    int player1Knights = countKnights(player1);
-    int player2Knights = countKnights(player2);
-    int player1Mages = countMages(player1);
-    int player2Mages = countMages(player2);
-    
-    float player1DamageReduction = (player1Warriors >= WARRIOR_SYNERGY_THRESHOLD) ? WARRIOR_DAMAGE_REDUCTION : 0.0f;
-    float player2DamageReduction = (player2Warriors >= WARRIOR_SYNERGY_THRESHOLD) ? WARRIOR_DAMAGE_REDUCTION : 0.0f;
-    float player1AttackSpeed = (player1Trolls >= TROLL_SYNERGY_THRESHOLD) ? TROLL_ATTACK_SPEED_BONUS : 0.0f;
-    float player2AttackSpeed = (player2Trolls >= TROLL_SYNERGY_THRESHOLD) ? TROLL_ATTACK_SPEED_BONUS : 0.0f;
-    bool player1HasElfSynergy = player1Elves >= ELF_SYNERGY_THRESHOLD;
-    bool player2HasElfSynergy = player2Elves >= ELF_SYNERGY_THRESHOLD;
-    float player1KnightReduction = (player1Knights >= KNIGHT_SYNERGY_THRESHOLD) ? KNIGHT_DAMAGE_REDUCTION : 0.0f;
-    float player2KnightReduction = (player2Knights >= KNIGHT_SYNERGY_THRESHOLD) ? KNIGHT_DAMAGE_REDUCTION : 0.0f;
-    float player1MageBoost = (player1Mages >= MAGE_SYNERGY_THRESHOLD) ? MAGE_DAMAGE_BOOST : 0.0f;
-    float player2MageBoost = (player2Mages >= MAGE_SYNERGY_THRESHOLD) ? MAGE_DAMAGE_BOOST : 0.0f;
-    
-    // Battle simulation
-    std::vector<AutoChessUnit> team1 = player1.board;
-    std::vector<AutoChessUnit> team2 = player2.board;
-    
-    int team1Health = calculateTeamHealth(team1);
-    int team2Health = calculateTeamHealth(team2);
-    int initialTeam1Health = team1Health;
-    int initialTeam2Health = team2Health;
-    
-    // Simple battle: units attack in order
-    while (!team1.empty() && !team2.empty()) {
-        // Team 1 attacks
-        for (auto &unit : team1) {
-            if (!team2.empty()) {
-                // Check for dodge
-                if (player2HasElfSynergy && shouldDodge()) {
-                    continue; // Attack dodged
-                }
-                
-                int damage = unit.damage * (1.0f - player2DamageReduction - player2KnightReduction);
-                // Apply attack speed bonus
-                if (player1AttackSpeed > 0) {
-                    damage = static_cast<int>(damage * (1.0f + player1AttackSpeed));
-                }
-                // Apply mage damage boost
-                if (player1MageBoost > 0 && unit.class_ == "Mage") {
-                    damage = static_cast<int>(damage * (1.0f + player1MageBoost));
-                }
-                team2[0].health -= damage;
-                if (team2[0].health <= 0) {
-                    team2.erase(team2.begin());
-                }
-            }
-        }
-        
-        // Team 2 attacks
-        for (auto &unit : team2) {
-            if (!team1.empty()) {
-                // Check for dodge
-                if (player1HasElfSynergy && shouldDodge()) {
-                    continue; // Attack dodged
-                }
-                
-                int damage = unit.damage * (1.0f - player1DamageReduction - player1KnightReduction);
-                // Apply attack speed bonus
-                if (player2AttackSpeed > 0) {
-                    damage = static_cast<int>(damage * (1.0f + player2AttackSpeed));
-                }
-                // Apply mage damage boost
-                if (player2MageBoost > 0 && unit.class_ == "Mage") {
-                    damage = static_cast<int>(damage * (1.0f + player2MageBoost));
-                }
-                team1[0].health -= damage;
-                if (team1[0].health <= 0) {
-                    team1.erase(team1.begin());
-                }
-            }
-        }
-    }
-    
-    // Calculate results
-    bool player1Won = !team1.empty();
-    int player1HealthLost = initialTeam1Health - calculateTeamHealth(team1);
-    int player2HealthLost = initialTeam2Health - calculateTeamHealth(team2);
+    // Synergies are kept up to date as units are placed
+    const AutoChessSynergies &synergies1 = player1.synergies;
+    const AutoChessSynergies &synergies2 = player2.synergies;
+
+    BattleTeam team1, team2;
+    fillBattleTeam(team1, player1.board.data(), player1.board.size(), synergies1, synergies2);
+    fillBattleTeam(team2, player2.board.data(), player2.board.size(), synergies2, synergies1);
+
+    // Record the battle for 'ac log' and tools/battle_replay
+    BattleLog &log = game.battleLogs[game.battleLogNext];
+    game.battleLogNext = (game.battleLogNext + 1) % AUTOCHESS_BATTLE_LOGS;
+    if (game.battleLogCount < AUTOCHESS_BATTLE_LOGS)
+        game.battleLogCount++;
+    log.players[0] = player1Id;
+    log.players[1] = player2Id;
+    log.round = game.round;
+    game.rng.save(log.rng);
+    log.teams[0] = team1;
+    log.teams[1] = team2;
+    log.eventCount = 0;
+    log.truncated = false;
+
+    BattleResult result = runBattle(team1, team2, elfDodge, &game.rng, &log);
+    bool player1Won = result.team1Won;
+    int player1HealthLost = result.healthLost[0];
+    int player2HealthLost = result.healthLost[1];
     
     // Send results to players using the new function
-    sendBattleResults(player1Id, game.round, player1Won, player1HealthLost,
-                     player1Warriors >= WARRIOR_SYNERGY_THRESHOLD,
-                     player1Trolls >= TROLL_SYNERGY_THRESHOLD,
-                     player1Elves >= ELF_SYNERGY_THRESHOLD,
-                     player1Knights >= KNIGHT_SYNERGY_THRESHOLD,
-                     player1Mages >= MAGE_SYNERGY_THRESHOLD);
-                     
-    sendBattleResults(player2Id, game.round, !player1Won, player2HealthLost,
-                     player2Warriors >= WARRIOR_SYNERGY_THRESHOLD,
-                     player2Trolls >= TROLL_SYNERGY_THRESHOLD,
-                     player2Elves >= ELF_SYNERGY_THRESHOLD,
-                     player2Knights >= KNIGHT_SYNERGY_THRESHOLD,
-                     player2Mages >= MAGE_SYNERGY_THRESHOLD);
-}
-
-int GamesModule::countWarriors(const AutoChessPlayer &player)
-{
-    int count = 0;
-    for (const auto &unit : player.board) {
-        if (unit.class_ == "Warrior") {
-            count++;
-        }
-    }
-    return count;
-}
-
-int GamesModule::countTrolls(const AutoChessPlayer &player)
-{
-    int count = 0;
-    for (const auto &unit : player.board) {
-        if (unit.race == "Orc") {
-            count++;
-        }
-    }
-    return count;
+    sendBattleResults(player1Id, game.round, player1Won, player1HealthLost, synergies1);
+    sendBattleResults(player2Id, game.round, !player1Won, player2HealthLost, synergies2);
 }
 
-int GamesModule::countElves(const AutoChessPlayer &player)
-{
-    int count = 0;
-    for (const auto &unit : player.board) {
-        if (unit.race == "Elf") {
-            count++;
-        }
-    }
-    return count;
-}
 
-bool GamesModule::shouldDodge()
-{
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
-    return dis(gen) < ELF_DODGE_CHANCE;
-}
 
 void GamesModule::distributeGold(AutoChessGame &game)
 {
@@ -1549,7 +2762,7 @@ void GamesModule::distributeGold(AutoChessGame &game)
         int interest = std::min(player.second.gold / 10, 5);
         player.second.gold += interest;
         
-        player.second.wasUpdated = time(nullptr);
+        player.second.wasUpdated = nowTick;
     }
 }
 
@@ -1562,7 +2775,7 @@ void GamesModule::distributeMana(AutoChessGame &game)
         // Cap mana at 100
         player.second.mana = std::min(player.second.mana, 100);
         
-        player.second.wasUpdated = time(nullptr);
+        player.second.wasUpdated = nowTick;
     }
 }
 
@@ -1575,67 +2788,25 @@ void GamesModule::checkLevelUp(AutoChessPlayer &player)
     if (player.level < 10 && player.experience >= xpPerLevel[player.level]) {
         player.level++;
         player.experience -= xpPerLevel[player.level - 1];
-        player.wasUpdated = time(nullptr);
-    }
-}
-
-int GamesModule::countKnights(const AutoChessPlayer &player)
-{
-    int count = 0;
-    for (const auto &unit : player.board) {
-        if (unit.race == "Human") {
-            count++;
-        }
-    }
-    return count;
-}
-
-int GamesModule::countMages(const AutoChessPlayer &player)
-{
-    int count = 0;
-    for (const auto &unit : player.board) {
-        if (unit.class_ == "Mage") {
-            count++;
-        }
+        player.wasUpdated = nowTick;
     }
-    return count;
 }
 
-void GamesModule::sendBattleResults(uint32_t playerId, int round, bool won, int healthLost, 
-                                  bool hasWarrior, bool hasTroll, bool hasElf, 
-                                  bool hasKnight, bool hasMage)
+void GamesModule::sendBattleResults(uint32_t playerId, int round, bool won, int healthLost,
+                                    const AutoChessSynergies &synergies)
 {
     // First message: Basic battle results
-    std::string msg1 = "Round " + std::to_string(round) + " Battle:\n";
-    msg1 += won ? "Victory! " : "Defeat! ";
-    msg1 += "Lost " + std::to_string(healthLost) + " health";
-    
-    auto reply1 = allocDataPacket();
-    reply1->decoded.payload.size = msg1.length();
-    memcpy(reply1->decoded.payload.bytes, msg1.c_str(), reply1->decoded.payload.size);
-    reply1->to = playerId;
-    service->sendToMesh(reply1);
-    
+    ReplyWriter out = replyWriter();
+    out << "Round " << round << " Battle:\n" << (won ? "Victory! " : "Defeat! ") << "Lost " << healthLost << " health";
+    sendReply(playerId, out, ReplyPriority::Broadcast);
+
     // Second message: Active synergies
-    std::string msg2 = "Active synergies:\n";
-    if (hasWarrior) msg2 += "Warriors (-20% dmg)\n";
-    if (hasTroll) msg2 += "Trolls (+30% speed)\n";
-    if (hasElf) msg2 += "Elves (25% dodge)\n";
-    if (hasKnight) msg2 += "Knights (-15% dmg)\n";
-    if (hasMage) msg2 += "Mages (+25% dmg)";
-    
-    auto reply2 = allocDataPacket();
-    reply2->decoded.payload.size = msg2.length();
-    memcpy(reply2->decoded.payload.bytes, msg2.c_str(), reply2->decoded.payload.size);
-    reply2->to = playerId;
-    service->sendToMesh(reply2);
+    out.clear();
+    out << "Active synergies:\n";
+    for (size_t i = 0; i < SYNERGY_COUNT; i++) {
+        if (synergies.active & (1u << i))
+            out << SYNERGY_TEXT[i];
+    }
+    sendReply(playerId, out, ReplyPriority::Broadcast);
 }
 
-int GamesModule::calculateTeamHealth(const std::vector<AutoChessUnit> &team)
-{
-    int totalHealth = 0;
-    for (const auto &unit : team) {
-        totalHealth += unit.health;
-    }
-    return totalHealth;
-} 
\ No newline at end of file
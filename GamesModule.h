@@ -1,29 +1,182 @@
 #pragma once
+#include "AutoChessBattle.h"
+#include "GamesRandom.h"
 #include "SinglePortModule.h"
+#include "concurrency/OSThread.h"
+#include <array>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <map>
-#include <ctime>
+#include <unordered_map>
 #include <vector>
 
-// Game state structure for Tic Tac Toe
+// Which game a text command addresses (None for module-wide commands like "help")
+enum class GameKind : uint8_t { None, TicTacToe, Hangman, RPS, AutoChess };
+
+static constexpr size_t GAME_KIND_COUNT = static_cast<size_t>(GameKind::AutoChess) + 1;
+
+// Hop filter value that matches every open game
+static const uint8_t LOBBY_ANY_HOPS = 0xFF;
+
+// Intrusive link that puts a game waiting for players into a LobbyQueue.
+// Copies start out unlinked; only the instance stored in the game map is queued.
+struct LobbyLink {
+    LobbyLink *prev = nullptr;
+    LobbyLink *next = nullptr;
+    uint32_t gameId = 0;
+    uint8_t hostHops = LOBBY_ANY_HOPS;  // Hops to the host when the game was created
+    bool queued = false;
+
+    LobbyLink() = default;
+    LobbyLink(const LobbyLink &) {}
+    LobbyLink &operator=(const LobbyLink &) { return *this; }
+};
+
+// FIFO of open games of one type. Push, remove and unfiltered lookup are O(1)
+// and never allocate, the links live inside the games themselves.
+class LobbyQueue
+{
+  public:
+    void push(LobbyLink &link, uint32_t gameId, uint8_t hostHops);
+    void remove(LobbyLink &link);
+    LobbyLink *front(uint8_t maxHops = LOBBY_ANY_HOPS) const;  // Oldest game hosted within maxHops
+
+  private:
+    LobbyLink *head = nullptr;
+    LobbyLink *tail = nullptr;
+};
+
+// Intrusive timer entry embedded in every game; see TimerWheel.
+// Copies start out unarmed; only the instance stored in the game map is scheduled.
+struct GameTimer {
+    GameTimer **pprev = nullptr;  // The slot head or previous timer's next pointer
+    GameTimer *next = nullptr;
+    uint32_t expiresAt = 0;  // Module tick (seconds since boot)
+    uint32_t gameId = 0;
+    GameKind game = GameKind::None;
+    bool armed = false;
+
+    GameTimer() = default;
+    GameTimer(const GameTimer &) {}
+    GameTimer &operator=(const GameTimer &) { return *this; }
+};
+
+// Two level hashed timer wheel with one second resolution. Level 0 holds the
+// timers due within WHEEL_SLOTS seconds, level 1 those due within WHEEL_SLOTS^2
+// seconds and is cascaded into level 0 every WHEEL_SLOTS ticks. Timers further
+// out park in the last level 1 slot and are re-filed when it cascades.
+class TimerWheel
+{
+  public:
+    static const uint32_t WHEEL_BITS = 6;
+    static const uint32_t WHEEL_SLOTS = 1 << WHEEL_BITS;
+
+    // Arm timer for tick expiresAt; now is the current tick
+    void schedule(GameTimer &timer, uint32_t now, uint32_t expiresAt);
+    void cancel(GameTimer &timer);
+    // Advance to tick now; returns the expired timers, already disarmed, chained through next
+    GameTimer *advance(uint32_t now);
+
+  private:
+    GameTimer *level0[WHEEL_SLOTS] = {};
+    GameTimer *level1[WHEEL_SLOTS] = {};
+    uint32_t currentTick = 0;
+    uint32_t armedCount = 0;
+
+    void link(GameTimer *&slot, GameTimer &timer);
+    GameTimer *&slotFor(uint32_t expiresAt);
+};
+
+// Tic Tac Toe lines as square masks, bit i = square i+1: rows, columns, diagonals
+constexpr uint16_t TTT_WIN_MASKS[8] = {0007, 0070, 0700, 0111, 0222, 0444, 0421, 0124};
+
+constexpr bool hasTicTacToeLine(uint16_t mask)
+{
+    for (uint16_t line : TTT_WIN_MASKS) {
+        if ((mask & line) == line)
+            return true;
+    }
+    return false;
+}
+
+// Game state structure for Tic Tac Toe. Square i (shown as i+1) is bit i of a mask.
 struct TicTacToeGame {
-    char board[9];
+    uint16_t xMask;
+    uint16_t oMask;
     uint32_t player1;
     uint32_t player2;
     uint32_t currentPlayer;
-    time_t wasUpdated;  // When the game was updated/created
+    bool isBotGame = false;         // Player 2 is the built-in bot
+    uint8_t botRandomPercent = 0;   // Chance the bot plays a random square instead of the best one
+    GamesRandom rng;                // Seeded by seedGame
+    uint32_t version = 0;  // Changes with every state change, see touchGame
+    GameTimer timer;    // Inactivity timeout
+    LobbyLink lobby;    // Queued while waiting for player 2
+
+    // 'X', 'O' or ' ' for square i
+    char squareAt(int i) const { return (xMask >> i) & 1 ? 'X' : ((oMask >> i) & 1 ? 'O' : ' '); }
 };
 
-// Game state structure for Hangman
+// Longest Hangman word; longer dictionary words are never picked
+static const int HANGMAN_MAX_WORD_LEN = 16;
+
+// Game state structure for Hangman. Letters are bits 0-25 ('A' to 'Z') and
+// word positions are bits 0-15, so a guess is a handful of mask operations.
 struct HangmanGame {
-    std::string word;
-    std::string guessedLetters;
-    std::string currentState;  // Current state of the word with _ for unguessed letters
+    char word[HANGMAN_MAX_WORD_LEN + 1];      // Uppercase, NUL terminated
+    uint8_t length;
+    int8_t remainingGuesses;
+    uint16_t revealedMask;                    // Positions shown to the player
+    uint32_t guessedMask;                     // Letters guessed so far
+    uint16_t letterPositions[26];             // Positions of each letter in the word
+    GamesRandom rng;                          // Seeded by seedGame
     uint32_t player;
-    int remainingGuesses;
-    time_t wasUpdated;
+    uint32_t version = 0;
+    GameTimer timer;
+
+    uint16_t fullMask() const { return static_cast<uint16_t>((1u << length) - 1); }
+    char letterAt(int i) const { return (revealedMask & (1u << i)) ? word[i] : '_'; }
 };
 
+#if ARCH_PORTDUINO
+#ifndef HANGMAN_DICTIONARY_PATH
+#define HANGMAN_DICTIONARY_PATH "/etc/meshtasticd/hangman.dict"
+#endif
+
+// Large Hangman word list built by bin/build-hangman-dict.py. The file is
+// mapped rather than read, so startup time and resident memory do not grow
+// with its size. Layout (little endian):
+//   char magic[4] = "HMD1", uint32_t reserved
+//   Bucket buckets[MAX_LENGTH + 1][DIFFICULTIES], offsets from the file start
+//   words of one bucket back to back, uppercase, no separators
+class HangmanDictionary
+{
+  public:
+    static constexpr int MAX_LENGTH = HANGMAN_MAX_WORD_LEN;
+    static constexpr int DIFFICULTIES = 3;
+
+    ~HangmanDictionary();
+    bool open(const char *path);
+
+    // Words of one difficulty, or of all of them for -1
+    uint32_t count(int difficulty) const;
+    std::string_view word(int difficulty, uint32_t n) const;
+
+  private:
+    struct Bucket {
+        uint32_t offset;
+        uint32_t count;
+    };
+    static constexpr size_t HEADER_LEN = 8 + sizeof(Bucket) * (MAX_LENGTH + 1) * DIFFICULTIES;
+
+    const char *data = nullptr;
+    size_t size = 0;
+    const Bucket *buckets = nullptr;
+};
+#endif
+
 // Game state structure for Rock Paper Scissors
 struct RPSGame {
     uint32_t player1;
@@ -33,25 +186,35 @@ struct RPSGame {
     bool player1Ready;
     bool player2Ready;
     bool isBotGame;      // Whether this is a game against a bot
-    time_t wasUpdated;
-};
-
-// Game state structure for Auto Chess
-struct AutoChessUnit {
-    std::string name;
-    int level;          // 1-3 stars
-    int cost;           // 1-5 gold
-    int health;
-    int damage;
-    int mana;
-    std::string race;   // e.g., "Human", "Elf", "Orc"
-    std::string class_; // e.g., "Warrior", "Mage", "Assassin"
+    GamesRandom rng;     // Seeded by seedGame
+    uint32_t version = 0;
+    GameTimer timer;
+    LobbyLink lobby;     // Queued while waiting for player 2
 };
 
 // Shop structure for Auto Chess
 struct AutoChessShop {
     std::vector<AutoChessUnit> availableUnits;  // Current shop units
-    time_t lastRefresh;  // When the shop was last refreshed
+    uint32_t lastRefresh;  // Module tick of the last refresh
+};
+
+// What a player was last sent, so later updates can be sent as deltas
+struct AutoChessView {
+    static const uint8_t MAX_UNITS = 16;
+    struct UnitList {
+        uint8_t count;
+        uint8_t units[MAX_UNITS];  // Indices into UNIT_TEMPLATES
+    };
+
+    bool valid = false;     // Cleared when the client may be out of step, forcing a full resync
+    uint16_t sequence = 0;  // Number of the last update sent, lets the client spot a gap
+    int level;
+    int experience;
+    int gold;
+    int mana;
+    UnitList shop;
+    UnitList bench;
+    UnitList board;
 };
 
 struct AutoChessPlayer {
@@ -62,43 +225,428 @@ struct AutoChessPlayer {
     int mana;          // Current mana
     std::vector<AutoChessUnit> bench;    // Units waiting to be placed
     std::vector<AutoChessUnit> board;    // Units on the board
+    AutoChessSynergies synergies;        // Of the units on the board
     AutoChessShop shop;  // Player's shop
-    time_t wasUpdated;
+    uint32_t wasUpdated;  // Module tick
+    AutoChessView sent;   // State as last sent to the player
 };
 
+// Seats in one AutoChess game
+static const size_t AUTOCHESS_MAX_PLAYERS = 4;
+
+// Units offered in each shop refresh
+static const size_t AUTOCHESS_SHOP_SIZE = 5;
+
+// Battle logs kept per game: every battle of the last AUTOCHESS_LOG_ROUNDS rounds,
+// more rounds when the game has fewer players
+static const size_t AUTOCHESS_LOG_ROUNDS = 3;
+static const size_t AUTOCHESS_BATTLE_LOGS = AUTOCHESS_MAX_PLAYERS / 2 * AUTOCHESS_LOG_ROUNDS;
+
 struct AutoChessGame {
     std::map<uint32_t, AutoChessPlayer> players;
     int round;          // Current round
     bool isActive;      // Whether the game is active
-    time_t wasUpdated;
+    uint32_t wasUpdated;  // Module tick of the last round or join
+    uint32_t nextRoundTick;  // When the scheduler runs the next round
+    uint32_t roundToken;     // Matches the live entry in the round heap
+    uint32_t version = 0;    // Changes with every player command and round
+    GamesRandom rng;         // Seeded by seedGame; shops, pairings and dodges
+    GameTimer timer;    // Inactivity timeout, reset by player commands
+    LobbyLink lobby;    // Queued while there are free seats
+
+    // Battles of the last few rounds for 'ac log', a ring overwriting the oldest
+    BattleLog battleLogs[AUTOCHESS_BATTLE_LOGS];
+    uint8_t battleLogCount = 0;  // Logs held
+    uint8_t battleLogNext = 0;   // Slot the next battle is recorded in
+};
+
+// Sessions a node currently takes part in, indexed by GameKind. Each entry is
+// the key of the game in its active*Games map, or 0 when there is none.
+struct PlayerSessions {
+    uint32_t gameIds[GAME_KIND_COUNT];
+};
+
+// Argument layout expected after a command verb
+enum class ArgSchema : uint8_t {
+    None,     // No arguments
+    Char,     // The verb itself is a single character (move, guess or choice)
+    Int,      // One integer
+    IntPair,  // Two integers separated by whitespace
+    OptInt,   // Zero or one integer
+    OptWord   // Zero or one word
+};
+
+// Arguments parsed in place by the dispatcher
+struct CommandArgs {
+    char letter;
+    uint8_t count;  // Number of integers parsed into values
+    int64_t values[2];
+    std::string_view word;  // Set by OptWord, empty if absent
+};
+
+// Counters reported by the "gamestats" command
+struct GamesStats {
+    uint32_t commandsHandled;   // Packets dispatched to a game handler
+    uint32_t rejectedMessages;  // Text packets that were not game commands
+    uint32_t rejectedBytes;     // Payload bytes of those packets
+    uint32_t fragmentedReplies; // Replies too long for a single packet
+    uint32_t fragmentsSent;     // Packets used by those replies
+    uint32_t truncatedReplies;  // Replies cut off at MAX_REPLY_FRAGMENTS
+    uint32_t coalescedReplies;  // Replies merged into a pending packet, one packet saved each
+    uint32_t supersededReplies; // Queued state updates replaced by a newer one
+    uint32_t droppedReplies;    // Replies evicted or refused because the TX queue was full
+    uint32_t airtimeMs;         // Estimated airtime of everything sent
+    uint32_t cacheHits;         // View requests answered from the render cache
+    uint32_t cacheMisses;       // View requests that had to be rendered
 };
 
-class GamesModule : public SinglePortModule
+// Last rendered view reply ("ttt board", "h state", "ac state") for one
+// player and game. It stays valid while the game's version is unchanged.
+// The bytes live in the module's fixed render arena.
+struct RenderCacheEntry {
+    uint32_t player;
+    GameKind game;
+    bool binary;       // Rendered for the binary protocol
+    uint32_t version;  // Game version the reply was rendered from
+    uint32_t lastUsed;
+    uint16_t offset;   // Start of the reply in the render arena
+    uint16_t length;
+};
+
+// Send order of queued replies, most urgent first
+enum class ReplyPriority : uint8_t {
+    Direct,     // Answer to the sender's own command
+    Turn,       // Tells another player it is their move or the game changed
+    Broadcast,  // Round results, game start and timeout notices
+};
+
+// A reply waiting for airtime. Open entries still accept text for the same
+// node and priority until their coalescing window closes.
+struct QueuedReply {
+    uint32_t to;
+    uint32_t queuedAt;       // millis() when the entry was created
+    uint32_t sequence;       // FIFO order within a priority
+    ReplyPriority priority;
+    GameKind stateOf;        // Entries with the same (to, stateOf) replace each other, None for plain replies
+    bool used;
+    bool sealed;             // Closed to coalescing, e.g. fragments and state updates
+    bool binaryPort;         // Send on GAMES_BINARY_PORTNUM instead of the text port
+    uint16_t length;
+    char text[meshtastic_Constants_DATA_PAYLOAD_LEN];
+};
+
+// Appends text to a caller-owned fixed buffer. Output past the capacity is
+// dropped and flagged rather than reallocated, so rendering never touches the heap.
+class ReplyWriter
+{
+  public:
+    ReplyWriter(char *buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+    ReplyWriter &operator<<(std::string_view text);
+    ReplyWriter &operator<<(const char *text) { return *this << std::string_view(text); }
+    ReplyWriter &operator<<(char c);
+    ReplyWriter &varint(uint64_t value);  // LEB128, for the binary protocol
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value &&
+                                                      !std::is_same<T, bool>::value,
+                                                  int>::type = 0>
+    ReplyWriter &operator<<(T value)
+    {
+        if (std::is_signed<T>::value)
+            return writeSigned(static_cast<int64_t>(value));
+        return writeUnsigned(static_cast<uint64_t>(value));
+    }
+
+    const char *data() const { return buffer; }
+    size_t size() const { return length; }
+    bool overflowed() const { return overflow; }
+    void clear()
+    {
+        length = 0;
+        overflow = false;
+    }
+
+  private:
+    char *buffer;
+    size_t capacity;
+    size_t length = 0;
+    bool overflow = false;
+
+    ReplyWriter &writeSigned(int64_t value);
+    ReplyWriter &writeUnsigned(uint64_t value);
+};
+
+// Entry in the AutoChess round heap. Entries are never removed early; a
+// token that no longer matches its game marks the entry as stale.
+struct RoundDeadline {
+    uint32_t dueTick;
+    uint32_t gameId;
+    uint32_t token;
+
+    bool operator>(const RoundDeadline &other) const { return static_cast<int32_t>(dueTick - other.dueTick) > 0; }
+};
+
+// Port of the compact binary protocol. Requests are GAMES_BINARY_MAGIC followed
+// by the same command text as on the text port; replies to nodes that use this
+// port are binary messages when they carry game state, and plain text otherwise.
+static const meshtastic_PortNum GAMES_BINARY_PORTNUM = meshtastic_PortNum_PRIVATE_APP;
+
+// First byte of every binary request. Other private apps share the port, so
+// requests without it are ignored. Changes with the protocol version.
+static const uint8_t GAMES_BINARY_MAGIC = 0xA1;
+
+// First byte of a binary reply. Text replies never start with a byte this
+// low, so clients can tell the two apart. Fields are varints unless noted.
+enum class BinaryReply : uint8_t {
+    TicTacToe = 1,  // status, X mask, O mask (bit i = square i+1), your mark (byte)
+    Hangman = 2,    // status, remaining guesses, guessed mask (bit 0 = A), length, letters (bytes, '_' if hidden)
+    RPS = 3,        // player 1 choice, player 2 choice (bytes), outcome (0 tie, 1 or 2 winner), bot game
+    AutoChess = 4,  // event, sequence, level, xp, gold, mana, players, active, then shop, bench and
+                    // board each as a count followed by unit template indices
+    BattleLog = 5,  // encodeBattleLog() bytes as they are
+};
+
+// Game status carried by binary TicTacToe and Hangman replies
+enum class BinaryStatus : uint8_t {
+    Playing,
+    OpponentTurn,
+    YourTurn,
+    XWins,
+    OWins,
+    Draw,
+    Won,
+    Lost,
+    AlreadyGuessed,
+};
+
+// Why an AutoChess state update was sent
+enum class AutoChessEvent : uint8_t {
+    State,
+    NewGame,
+    Joined,
+    Purchased,
+    Sold,
+    Placed,
+};
+
+class GamesModule;
+
+// One row of the command dispatch table
+struct GameCommand {
+    GameKind game;
+    std::string_view verb;
+    ArgSchema schema;
+    const char *usageError;  // Sent when the arguments do not match the schema
+    bool (GamesModule::*handler)(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+};
+
+class GamesModule : public SinglePortModule, private concurrency::OSThread
 {
   public:
-    GamesModule() : SinglePortModule("games", meshtastic_PortNum_TEXT_MESSAGE_APP) {}
+    GamesModule();
+
+    // Inactivity timeout for one game type, applied the next time a game is touched
+    void setGameTimeout(GameKind game, uint32_t seconds);
+
+    // Entry point for GamesBinaryModule: same commands, answered in binary
+    ProcessMessage handleBinaryReceived(const meshtastic_MeshPacket &mp);
+
+    // Share of airtime game replies may use, in permille (10 = EU 1%), and the
+    // most that can be spent in one burst. A permille of 0 disables the budget,
+    // which is the default.
+    void setAirtimeBudget(uint16_t permille, uint32_t burstMs);
 
   protected:
     virtual meshtastic_MeshPacket *allocReply() override;
     virtual ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override;
+    ProcessMessage dispatch(const meshtastic_MeshPacket &mp, std::string_view text, bool binary);
+    void countRejected(const meshtastic_MeshPacket &mp, bool binary);
+
+    // Drives game expiry and AutoChess rounds independently of incoming traffic
+    virtual int32_t runOnce() override;
 
   private:
-    std::map<uint32_t, TicTacToeGame> activeGames;
-    std::map<uint32_t, HangmanGame> activeHangmanGames;
-    std::map<uint32_t, RPSGame> activeRPSGames;
-    std::map<uint32_t, AutoChessGame> activeAutoChessGames;  // Map of game ID to game state
+    std::unordered_map<uint32_t, TicTacToeGame> activeGames;
+    std::unordered_map<uint32_t, HangmanGame> activeHangmanGames;
+    std::unordered_map<uint32_t, RPSGame> activeRPSGames;
+    std::unordered_map<uint32_t, AutoChessGame> activeAutoChessGames;  // Map of game ID to game state
+
+    // Reverse index from node to the games it takes part in
+    std::unordered_map<uint32_t, PlayerSessions> playerSessions;
+    uint32_t findSession(uint32_t player, GameKind game) const;
+    void setSession(uint32_t player, GameKind game, uint32_t gameId);
+    void clearSession(uint32_t player, GameKind game);
+    TicTacToeGame *findTicTacToeGame(uint32_t player);
+    RPSGame *findRPSGame(uint32_t player);
+    AutoChessGame *findAutoChessGame(uint32_t player);
+
+    // Games waiting for players, oldest first
+    LobbyQueue ticTacToeLobby;
+    LobbyQueue rpsLobby;
+    LobbyQueue autoChessLobby;
+    static uint8_t hopsAway(const meshtastic_MeshPacket &mp);
+    static uint8_t hopFilter(const CommandArgs &args);
     static const int GAME_TIMEOUT_SECONDS = 600; // 10 minutes
+    static const int AUTOCHESS_TIMEOUT_SECONDS = 1800; // Rounds keep running, so allow longer idle periods
+    uint32_t gameTimeouts[GAME_KIND_COUNT] = {0, GAME_TIMEOUT_SECONDS, GAME_TIMEOUT_SECONDS, GAME_TIMEOUT_SECONDS,
+                                              AUTOCHESS_TIMEOUT_SECONDS};
+
+    // Monotonic clock, seconds since boot. Cached per packet so nothing depends on the RTC.
+    uint32_t nowTick = 0;
+    uint32_t lastTickMillis = 0;
+    uint32_t tickRemainderMs = 0;
+    void updateTick();
+
+    TimerWheel gameTimers;
+    uint32_t stateVersion = 0;  // Source of game versions, unique across all games
+
+    // Resets a game's inactivity timer and marks its state as changed
+    template <typename Game> void touchGame(GameKind kind, uint32_t gameId, Game &game)
+    {
+        game.version = ++stateVersion;
+        scheduleTimeout(kind, gameId, game.timer);
+    }
+    void scheduleTimeout(GameKind game, uint32_t gameId, GameTimer &timer);
+    void expireGames();
+
+    // Draws a seed for every new game; seeded once from the platform RNG
+    GamesRandom seedSource;
+    void seedGame(GamesRandom &rng, GameKind kind, uint32_t gameId);
+
+    // AutoChess round scheduling, a min-heap ordered by due tick
+    static const uint32_t SCHEDULER_INTERVAL_MS = 1000;  // Timer wheel resolution
+    static const uint32_t ROUND_BUDGET_MS = 50;          // Max time spent on rounds per run
+    static const uint32_t ROUND_YIELD_MS = 10;           // Delay before resuming leftover rounds
+    std::vector<RoundDeadline> roundHeap;
+    uint32_t nextRoundToken = 0;
+    void scheduleRound(uint32_t gameId, AutoChessGame &game, uint32_t dueTick);
+    void wakeScheduler(uint32_t delayMs = SCHEDULER_INTERVAL_MS);
     
+    // Command dispatch table and its perfect hash index
+    static const GameCommand COMMANDS[];
+    static const size_t COMMANDS_COUNT;
+    static const int COMMAND_SLOT_COUNT = 64;
+    static const uint32_t COMMAND_HASH_SEED = 29;
+    static const size_t MAX_COMMAND_WORD_LEN = 9;  // Longest first word, "gamestats"
+    static const std::array<int8_t, COMMAND_SLOT_COUNT> COMMAND_SLOTS;
+    static constexpr uint32_t commandHash(GameKind game, std::string_view verb);
+    static constexpr bool commandHashIsPerfect();
+    static constexpr std::array<int8_t, COMMAND_SLOT_COUNT> buildCommandSlots();
+    static const GameCommand *findCommand(GameKind game, std::string_view verb);
+    static bool parseArgs(ArgSchema schema, std::string_view text, CommandArgs &args);
+    static bool isGameTraffic(std::string_view payload);  // O(1) pre-filter for chat
+    GamesStats stats = {};
+
+    // Outgoing replies. Text longer than one payload is split at line breaks
+    // into numbered "i/n" fragments.
+    static const size_t MAX_REPLY_FRAGMENTS = 9;     // Keeps the header to one digit each
+    static const size_t REPLY_FRAGMENT_HEADER_LEN = 4;  // "i/n\n"
+    void sendReply(uint32_t to, const char *text, size_t len, ReplyPriority priority = ReplyPriority::Direct,
+                   GameKind stateOf = GameKind::None, bool supersede = true);
+    void sendReply(uint32_t to, const char *text, ReplyPriority priority = ReplyPriority::Direct)
+    {
+        sendReply(to, text, strlen(text), priority);
+    }
+    void sendReply(uint32_t to, const ReplyWriter &out, ReplyPriority priority = ReplyPriority::Direct,
+                   GameKind stateOf = GameKind::None, bool supersede = true)
+    {
+        sendReply(to, out.data(), out.size(), priority, stateOf, supersede);
+    }
+    static size_t fragmentEnd(const char *text, size_t len, size_t offset, size_t capacity);
+
+    // Binary replies, only for nodes that talk to us on the binary port. The
+    // senders return false for other nodes so callers fall back to text.
+    // Nodes whose last command came in on the binary port are kept in a small
+    // set, so the preference outlives their sessions. Free slots are filled
+    // first; once the set is full the slots are replaced in turn.
+    static const size_t BINARY_CLIENT_SLOTS = 16;
+    uint32_t binaryClients[BINARY_CLIENT_SLOTS] = {};
+    size_t nextBinaryClient = 0;
+    void setBinaryClient(uint32_t node, bool binary);
+    bool isBinaryClient(uint32_t node) const;
+    void sendBinary(uint32_t to, const char *data, size_t len, ReplyPriority priority, GameKind stateOf,
+                    bool supersede = true);
+    bool sendTicTacToeBinary(uint32_t to, const TicTacToeGame &game, BinaryStatus status, ReplyPriority priority,
+                             GameKind stateOf);
+    bool sendHangmanBinary(uint32_t to, const HangmanGame &game, BinaryStatus status, GameKind stateOf);
+    bool sendRPSBinary(uint32_t to, const RPSGame &game, ReplyPriority priority);
+    static void writeTicTacToeBinary(ReplyWriter &out, const TicTacToeGame &game, BinaryStatus status, uint32_t viewer);
+    static void writeHangmanBinary(ReplyWriter &out, const HangmanGame &game, BinaryStatus status);
+
+    // Render cache for repeated view requests. Entries are packed into a fixed
+    // arena that is compacted when the free bytes at its end run out.
+    static const size_t RENDER_CACHE_SLOTS = 8;
+    static const size_t RENDER_CACHE_BYTES = 2048;
+    RenderCacheEntry renderCache[RENDER_CACHE_SLOTS] = {};
+    char renderArena[RENDER_CACHE_BYTES];
+    size_t renderCacheBytes = 0;  // Bytes held by live entries
+    size_t renderArenaEnd = 0;    // End of the last entry written to the arena
+    uint32_t renderCacheClock = 0;
+    bool sendCachedView(uint32_t to, GameKind game, uint32_t version);
+    void sendView(uint32_t to, GameKind game, uint32_t version, const ReplyWriter &out);
+    void dropCachedView(RenderCacheEntry &entry);
+    void compactRenderArena();
+
+    // Game-level TX queue. Short replies to the same node and priority are
+    // merged for up to COALESCE_WINDOW_MS, then everything drains in priority
+    // order as the airtime budget allows. The budget is off until the region's
+    // duty cycle is configured through setAirtimeBudget.
+    static const uint32_t COALESCE_WINDOW_MS = 250;
+    static const size_t TX_QUEUE_SLOTS = 16;
+    static const size_t TX_DIRECT_RESERVE = 4;           // Slots rounds and timeouts leave for command replies
+    static const uint32_t TX_OVERHEAD_MS = 250;          // Preamble and headers at LongFast
+    static const uint32_t TX_US_PER_BYTE = 7500;         // Payload byte at LongFast
+    QueuedReply txQueue[TX_QUEUE_SLOTS] = {};
+    uint32_t txSequence = 0;
+    uint16_t airtimePermille = 0;
+    uint32_t airtimeBurstMs = 0;
+    uint64_t airtimeCredit = 0;  // Airtime ms scaled by 1000
+    uint32_t lastCreditMillis = 0;
+    QueuedReply *allocQueuedReply(ReplyPriority priority);
+    bool hasReplyRoom(size_t entries) const;
+    void queueReply(uint32_t to, const char *text, size_t len, ReplyPriority priority, GameKind stateOf,
+                    bool sealed);
+    void sealReplies(uint32_t to);
+    void supersedeReplies(uint32_t to, GameKind game);
+    void replyDropped(uint32_t to, GameKind stateOf);
+    int32_t drainReplies(uint32_t now);  // Returns ms until the next send is possible, or -1 if the queue is empty
+    static uint32_t estimateAirtimeMs(size_t len);
+
+    // Scratch space shared by all renderers; every reply is sent before the next one is written
+    static const size_t REPLY_BUFFER_LEN = MAX_REPLY_FRAGMENTS * (meshtastic_Constants_DATA_PAYLOAD_LEN - REPLY_FRAGMENT_HEADER_LEN);
+    char replyBuffer[REPLY_BUFFER_LEN];
+    ReplyWriter replyWriter() { return ReplyWriter(replyBuffer, sizeof(replyBuffer)); }
+
     // Word list for Hangman
     static const char* const HANGMAN_WORDS[];
-    static const int HANGMAN_WORDS_COUNT = 50;  // Number of words in the list
+    static const int HANGMAN_WORDS_COUNT;
+#if ARCH_PORTDUINO
+    HangmanDictionary hangmanDictionary;
+#endif
     
     // Auto Chess game handlers
-    bool handleAutoChessCommand(const meshtastic_MeshPacket &mp, const char *command);
+    bool cmdAutoChessNew(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessStatus(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessState(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessBuy(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessSell(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessPlace(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdAutoChessLog(const meshtastic_MeshPacket &mp, const CommandArgs &args);
     void startNewAutoChessGame(uint32_t player);
     bool joinAutoChessGame(uint32_t player, uint32_t gameId);
     void cleanupAutoChessGame(uint32_t gameId);
-    std::string getAutoChessStateString(const AutoChessPlayer &player);
+    void writeAutoChessState(ReplyWriter &out, const AutoChessPlayer &player);
+    static const char *const AUTOCHESS_EVENT_TEXT[];
+    void sendAutoChessUpdate(uint32_t playerId, AutoChessPlayer &player, AutoChessEvent event, bool fullSync);
+    static void writeAutoChessBinary(ReplyWriter &out, const AutoChessView &view, AutoChessEvent event,
+                                     size_t players, bool active);
+    static void writeUnitListBinary(ReplyWriter &out, const AutoChessView::UnitList &list);
+    static bool snapshotAutoChessView(AutoChessView &view, const AutoChessPlayer &player);
+    static bool fillUnitList(AutoChessView::UnitList &list, const std::vector<AutoChessUnit> &units);
+    static void writeAutoChessDelta(ReplyWriter &out, const AutoChessView &before, const AutoChessView &after);
+    static void writeUnitListDelta(ReplyWriter &out, const char *label, const AutoChessView::UnitList &before,
+                                   const AutoChessView::UnitList &after, bool &first);
     bool buyUnit(AutoChessPlayer &player, int unitIndex);
     bool sellUnit(AutoChessPlayer &player, int unitIndex);
     bool placeUnit(AutoChessPlayer &player, int benchIndex, int boardIndex);
@@ -106,51 +654,77 @@ class GamesModule : public SinglePortModule
     void distributeGold(AutoChessGame &game);
     void distributeMana(AutoChessGame &game);
     void checkLevelUp(AutoChessPlayer &player);
-    void refreshShop(AutoChessPlayer &player);  // Refresh shop with new units
-    std::string getShopString(const AutoChessPlayer &player);  // Get shop display string
+    void refreshShop(AutoChessPlayer &player, GamesRandom &rng);  // Refresh shop with new units
+    void writeShop(ReplyWriter &out, const AutoChessPlayer &player);  // Shop listing
     
     // Predefined units for the shop
-    static const AutoChessUnit UNIT_TEMPLATES[];
-    static const int UNIT_TEMPLATES_COUNT = 10;  // Number of different unit types
+    static const char *const UNIT_RACE_NAMES[];
+    static const char *const UNIT_CLASS_NAMES[];
+    static const AutoChessUnitTemplate &templateOf(const AutoChessUnit &unit) { return UNIT_TEMPLATES[unit.templateId]; }
+    static AutoChessUnit makeUnit(uint8_t templateId);
+    static void writeUnitName(ReplyWriter &out, const AutoChessUnit &unit);
     
+    // Module-wide command handlers
+    bool cmdHelp(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdStats(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+
     // Game command handlers
-    bool handleTicTacToeCommand(const meshtastic_MeshPacket &mp, const char *command);
+    bool cmdTicTacToeNew(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdTicTacToeJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdTicTacToeBoard(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdTicTacToeMove(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdTicTacToeBot(const meshtastic_MeshPacket &mp, const CommandArgs &args);
     bool handleTicTacToeMove(const meshtastic_MeshPacket &mp, int position);
     void startNewTicTacToeGame(uint32_t player1, uint32_t player2);
-    std::string getBoardString(const TicTacToeGame &game);
-    bool checkWin(const TicTacToeGame &game);
-    bool checkDraw(const TicTacToeGame &game);
-    void cleanupOldGames();  // Clean up games older than GAME_TIMEOUT_SECONDS
+    void writeBoard(ReplyWriter &out, const TicTacToeGame &game);
+    static bool checkDraw(const TicTacToeGame &game);
+    static const char *ticTacToeEnd(const TicTacToeGame &game, BinaryStatus &status);
+    static int chooseBotMove(TicTacToeGame &game);
+    void cleanupTicTacToeGame(uint32_t gameId);
 
     // Hangman game handlers
-    bool handleHangmanCommand(const meshtastic_MeshPacket &mp, const char *command);
-    void startNewHangmanGame(uint32_t player);
-    std::string getHangmanStateString(const HangmanGame &game);
+    bool cmdHangmanNew(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdHangmanState(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdHangmanGuess(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    void startNewHangmanGame(uint32_t player, int difficulty);
+    void cleanupHangmanGame(uint32_t gameId);
+    void writeHangmanState(ReplyWriter &out, const HangmanGame &game);
     bool makeHangmanGuess(const meshtastic_MeshPacket &mp, char guess);
-    bool checkHangmanWin(const HangmanGame &game);
-    std::string getRandomWord();
+    static bool checkHangmanWin(const HangmanGame &game);
+    std::string_view getRandomWord(GamesRandom &rng, int difficulty);
 
     // Rock Paper Scissors game handlers
-    bool handleRPSCommand(const meshtastic_MeshPacket &mp, const char *command);
+    bool cmdRPSNew(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdRPSBot(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdRPSJoin(const meshtastic_MeshPacket &mp, const CommandArgs &args);
+    bool cmdRPSChoice(const meshtastic_MeshPacket &mp, const CommandArgs &args);
     void startNewRPSGame(uint32_t player1, uint32_t player2, bool isBotGame = false);
     bool makeRPSChoice(const meshtastic_MeshPacket &mp, char choice);
-    std::string getRPSResult(const RPSGame &game);
+    void writeRPSResult(ReplyWriter &out, const RPSGame &game);
     void cleanupRPSGame(uint32_t gameId);
-    char getBotChoice();  // Get a random choice for the bot
+    static char getBotChoice(GamesRandom &rng);  // Get a random choice for the bot
 
     // Battle processing functions
     void processBattles(AutoChessGame &game);
     void processBattle(AutoChessGame &game, uint32_t player1Id, uint32_t player2Id);
-    void sendBattleResults(uint32_t playerId, int round, bool won, int healthLost,
-                          bool hasWarrior, bool hasTroll, bool hasElf,
-                          bool hasKnight, bool hasMage);
-    int calculateTeamHealth(const std::vector<AutoChessUnit> &team);
-
-    // Unit counting functions
-    int countWarriors(const AutoChessPlayer &player);
-    int countTrolls(const AutoChessPlayer &player);
-    int countElves(const AutoChessPlayer &player);
-    int countKnights(const AutoChessPlayer &player);
-    int countMages(const AutoChessPlayer &player);
-    bool shouldDodge();
+
+    const BattleLog *findBattleLog(uint32_t player, int round);
+    static const size_t BATTLE_LOG_HEX_LINE_BYTES = 32;  // Encoded bytes per line of 'ac log' hex
+    void sendBattleResults(uint32_t playerId, int round, bool won, int healthLost, const AutoChessSynergies &synergies);
+};
+
+// Receives the binary protocol on its own port and hands it to GamesModule
+class GamesBinaryModule : public SinglePortModule
+{
+  public:
+    explicit GamesBinaryModule(GamesModule &games) : SinglePortModule("gamesbin", GAMES_BINARY_PORTNUM), games(games) {}
+
+  protected:
+    virtual ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override
+    {
+        return games.handleBinaryReceived(mp);
+    }
+
+  private:
+    GamesModule &games;
 }; 
\ No newline at end of file
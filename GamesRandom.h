@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 (XSH RR, O'Neill 2014): 16 bytes of state instead of the ~5 KB of a
+// std::mt19937. Each game owns one, seeded with a fresh seed and the game as
+// stream, so any game can be replayed from the seed in the debug log.
+class GamesRandom
+{
+  public:
+    GamesRandom() { seed(0, 0); }
+
+    void seed(uint64_t seed, uint64_t stream)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old = state;
+        state = old * MULTIPLIER + increment;
+        return output(old);
+    }
+
+    // The generator as plain functions of its state, for callers that step
+    // many streams side by side
+    static const uint64_t MULTIPLIER = 6364136223846793005ULL;
+    static uint32_t output(uint64_t old)
+    {
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // Uniform in [0, bound), without modulo bias
+    uint32_t below(uint32_t bound)
+    {
+        uint32_t threshold = (0u - bound) % bound;
+        for (;;) {
+            uint32_t value = next();
+            if (value >= threshold)
+                return value % bound;
+        }
+    }
+
+    // Raw state, for battle logs that replay from the middle of a game
+    void save(uint64_t out[2]) const
+    {
+        out[0] = state;
+        out[1] = increment;
+    }
+    void restore(const uint64_t in[2])
+    {
+        state = in[0];
+        increment = in[1];
+    }
+
+    // Uniform in [0, 1)
+    float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+  private:
+    uint64_t state;
+    uint64_t increment;
+};
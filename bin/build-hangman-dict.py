@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Build the Hangman dictionary that portduino nodes map from
+HANGMAN_DICTIONARY_PATH (default /etc/meshtasticd/hangman.dict).
+
+    bin/build-hangman-dict.py words.txt hangman.dict
+
+The input has one word per line. Words are uppercased; words with anything
+other than A-Z, shorter than 4 or longer than 16 letters are skipped. The
+output is bucketed by length and difficulty, see HangmanDictionary in
+GamesModule.h for the layout.
+"""
+
+import struct
+import sys
+
+MAX_LENGTH = 16
+MIN_LENGTH = 4
+DIFFICULTIES = 3
+COMMON_LETTERS = set("ETAOINSHRDLU")
+
+
+def difficulty(word):
+    """Same rule as hangmanDifficulty() in GamesModule.cpp."""
+    return min(len(set(word) - COMMON_LETTERS), DIFFICULTIES - 1)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    buckets = [[[] for _ in range(DIFFICULTIES)] for _ in range(MAX_LENGTH + 1)]
+    seen = set()
+    with open(sys.argv[1], encoding="utf-8", errors="ignore") as words:
+        for line in words:
+            word = line.strip().upper()
+            if not (MIN_LENGTH <= len(word) <= MAX_LENGTH) or not word.isascii() or not word.isalpha():
+                continue
+            if word not in seen:
+                seen.add(word)
+                buckets[len(word)][difficulty(word)].append(word)
+
+    header_len = 8 + 8 * (MAX_LENGTH + 1) * DIFFICULTIES
+    table = b""
+    body = b""
+    for length in range(MAX_LENGTH + 1):
+        for level in range(DIFFICULTIES):
+            bucket = sorted(buckets[length][level])
+            table += struct.pack("<II", header_len + len(body), len(bucket))
+            body += "".join(bucket).encode("ascii")
+
+    with open(sys.argv[2], "wb") as out:
+        out.write(b"HMD1" + struct.pack("<I", 0) + table + body)
+
+    counts = [sum(len(buckets[n][d]) for n in range(MAX_LENGTH + 1)) for d in range(DIFFICULTIES)]
+    print(f"{len(seen)} words (easy {counts[0]}, medium {counts[1]}, hard {counts[2]})")
+
+
+if __name__ == "__main__":
+    main()
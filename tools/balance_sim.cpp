@@ -0,0 +1,168 @@
+// Monte Carlo balance sweep for AutoChess. Every unit type fields a board of
+// --size copies, and every pair of boards fights --battles seeded battles
+// through the same kernel the module uses. Win rates go to CSV; row beats
+// column that often, with sides swapped every other battle. The default batch
+// kernel runs 16 battles at a time through the vectorized kernel; --kernel
+// scalar runs them one by one through runBattle and gives the same table.
+// tools/bench/battle_bench measures the difference.
+//
+// Build from the repository root (add -mavx2 or -march=native for AVX2):
+//   g++ -std=c++17 -O2 -pthread -I. tools/balance_sim.cpp AutoChessBattle.cpp AutoChessBattleBatch.cpp -o balance_sim
+//
+// Usage:
+//   balance_sim [--battles N] [--size K] [--threads T] [--seed S] [--kernel batch|scalar] [--out file.csv]
+
+#include "AutoChessBattle.h"
+#include "AutoChessBattleBatch.h"
+#include "GamesRandom.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+struct Composition {
+    const char *name;
+    AutoChessUnit units[BATTLE_MAX_UNITS];
+    int count;
+    AutoChessSynergies synergies;
+};
+
+static Composition monoComposition(int templateId, int size)
+{
+    Composition composition = {};
+    composition.name = UNIT_TEMPLATES[templateId].name;
+    composition.count = size;
+    for (int i = 0; i < size; i++) {
+        const auto &info = UNIT_TEMPLATES[templateId];
+        composition.units[i] = {static_cast<uint8_t>(templateId), 1, info.health, info.mana};
+        composition.synergies.add(info);
+    }
+    return composition;
+}
+
+// Wins of a over b. Every battle has its own RNG stream, so results do not
+// depend on how many threads run, which thread gets the matchup or which
+// kernel fights it.
+static uint64_t runMatchup(const Composition &a, const Composition &b, uint64_t battles, uint64_t seed, uint64_t cell,
+                           bool batched)
+{
+    BattleTeam aFirst, bSecond, bFirst, aSecond;
+    fillBattleTeam(aFirst, a.units, a.count, a.synergies, b.synergies);
+    fillBattleTeam(bSecond, b.units, b.count, b.synergies, a.synergies);
+    bFirst = bSecond;
+    aSecond = aFirst;
+
+    uint64_t wins = 0;
+    if (!batched) {
+        for (uint64_t i = 0; i < battles; i++) {
+            GamesRandom rng;
+            rng.seed(seed, (cell << 32) | i);
+            BattleTeam team1 = (i & 1) ? bFirst : aFirst;
+            BattleTeam team2 = (i & 1) ? aSecond : bSecond;
+            wins += runBattle(team1, team2, elfDodge, &rng).team1Won != (i & 1);
+        }
+        return wins;
+    }
+
+    BattleBatch batch;
+    GamesRandom rngs[BATTLE_BATCH_LANES];
+    BattleResult results[BATTLE_BATCH_LANES];
+    for (uint64_t first = 0; first < battles; first += BATTLE_BATCH_LANES) {
+        batch.clear();
+        int lanes = battles - first < BATTLE_BATCH_LANES ? int(battles - first) : BATTLE_BATCH_LANES;
+        for (int lane = 0; lane < lanes; lane++) {
+            uint64_t i = first + lane;
+            rngs[lane].seed(seed, (cell << 32) | i);
+            if (i & 1)
+                batch.setLane(lane, bFirst, aSecond, &rngs[lane]);
+            else
+                batch.setLane(lane, aFirst, bSecond, &rngs[lane]);
+        }
+        runBattleBatch(batch, results);
+        for (int lane = 0; lane < lanes; lane++)
+            wins += results[lane].team1Won != ((first + lane) & 1);
+    }
+    return wins;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t battles = 100000;
+    int size = 3;
+    unsigned threads = std::thread::hardware_concurrency();
+    uint64_t seed = 1;
+    const char *outPath = nullptr;
+    bool batched = true;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--battles"))
+            battles = strtoull(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "--size"))
+            size = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads"))
+            threads = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seed"))
+            seed = strtoull(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "--kernel"))
+            batched = strcmp(argv[i + 1], "scalar") != 0;
+        else if (!strcmp(argv[i], "--out"))
+            outPath = argv[i + 1];
+        else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (size < 1 || size > BATTLE_MAX_UNITS || battles == 0) {
+        fprintf(stderr, "--size must be 1-%d and --battles at least 1\n", BATTLE_MAX_UNITS);
+        return 2;
+    }
+    if (threads == 0)
+        threads = 1;
+
+    std::vector<Composition> compositions;
+    for (int id = 0; id < UNIT_TEMPLATES_COUNT; id++)
+        compositions.push_back(monoComposition(id, size));
+
+    size_t n = compositions.size();
+    std::vector<uint64_t> wins(n * n);
+    std::atomic<size_t> nextMatchup{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (size_t cell; (cell = nextMatchup++) < n * n;)
+                wins[cell] = runMatchup(compositions[cell / n], compositions[cell % n], battles, seed, cell, batched);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double total = double(n * n) * battles;
+    fprintf(stderr, "%zu matchups x %llu battles on %u threads (%s): %.2f s, %.1f M battles/s\n", n * n,
+            (unsigned long long)battles, threads, batched ? battleBatchKernel() : "scalar", seconds,
+            total / seconds / 1e6);
+
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        perror(outPath);
+        return 1;
+    }
+    fprintf(out, "board");
+    for (const auto &column : compositions)
+        fprintf(out, ",%s", column.name);
+    fprintf(out, "\n");
+    for (size_t row = 0; row < n; row++) {
+        fprintf(out, "%s", compositions[row].name);
+        for (size_t column = 0; column < n; column++)
+            fprintf(out, ",%.4f", double(wins[row * n + column]) / battles);
+        fprintf(out, "\n");
+    }
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
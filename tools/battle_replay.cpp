@@ -0,0 +1,136 @@
+// Replays an AutoChess battle log from 'ac log' through the battle code and
+// checks that it plays out the same way.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -I. tools/battle_replay.cpp AutoChessBattle.cpp -o battle_replay
+//
+// Usage:
+//   battle_replay <hex>...          (the arguments are joined)
+//   battle_replay < message.txt     (joins consecutive hex lines, skipping the
+//                                    "i/n" fragment headers between them, and
+//                                    uses the longest such run)
+
+#include "AutoChessBattle.h"
+#include "GamesRandom.h"
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool isHexLine(const std::string &line)
+{
+    for (char c : line) {
+        if (!isxdigit(static_cast<unsigned char>(c)))
+            return false;
+    }
+    return !line.empty() && line.size() % 2 == 0;
+}
+
+// "1/3" and the like, which start each fragment of a long reply
+static bool isFragmentHeader(const std::string &line)
+{
+    return line.size() == 3 && isdigit(static_cast<unsigned char>(line[0])) && line[1] == '/' &&
+           isdigit(static_cast<unsigned char>(line[2]));
+}
+
+static std::vector<uint8_t> parseHex(const std::string &hex)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2)
+        bytes.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    return bytes;
+}
+
+static void printTeam(const char *name, const BattleTeam &team)
+{
+    printf("%s%s:", name, team.dodges ? " (dodges)" : "");
+    for (int i = 0; i < BATTLE_MAX_UNITS; i++) {
+        if (team.alive & (1u << i))
+            printf(" [%d: hp %d dmg %d]", i, team.health[i], team.damage[i]);
+    }
+    printf("\n");
+}
+
+// Walks the recorded events against the starting teams and prints them
+static void printEvents(const BattleLog &log)
+{
+    BattleTeam teams[2] = {log.teams[0], log.teams[1]};
+    static const char *const SIDE[] = {"A", "B"};
+    int round = 0, lastSide = 1;
+    for (int i = 0; i < log.eventCount; i++) {
+        uint8_t record = log.events[i];
+        int side = battleEventSide(record), unit = battleEventUnit(record);
+        if (side == 0 && lastSide == 1)
+            printf("Round %d\n", ++round);
+        lastSide = side;
+
+        BattleTeam &defender = teams[1 - side];
+        if (!defender.alive) {
+            printf("  event %d: defender has no units left\n", i);
+            return;
+        }
+        int front = __builtin_ctz(defender.alive);
+        if (battleEventKind(record) == BattleEvent::Dodge) {
+            printf("  %s%d -> %s%d dodged\n", SIDE[side], unit, SIDE[1 - side], front);
+            continue;
+        }
+        defender.health[front] -= teams[side].damage[unit];
+        printf("  %s%d -> %s%d %d dmg, hp %d%s\n", SIDE[side], unit, SIDE[1 - side], front, teams[side].damage[unit],
+               defender.health[front], battleEventKind(record) == BattleEvent::Kill ? ", dies" : "");
+        if (battleEventKind(record) == BattleEvent::Kill)
+            defender.alive &= ~(1u << front);
+    }
+    if (log.truncated)
+        printf("  ... log ends after %d attacks\n", log.eventCount);
+}
+
+int main(int argc, char **argv)
+{
+    std::string hex;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++)
+            hex += argv[i];
+    } else {
+        std::string run;
+        for (std::string line; std::getline(std::cin, line);) {
+            while (!line.empty() && isspace(static_cast<unsigned char>(line.back())))
+                line.pop_back();
+            if (isHexLine(line)) {
+                run += line;
+                if (run.size() > hex.size())
+                    hex = run;
+            } else if (!isFragmentHeader(line)) {
+                run.clear();
+            }
+        }
+    }
+
+    std::vector<uint8_t> bytes = parseHex(hex);
+    BattleLog log;
+    if (!isHexLine(hex) || !decodeBattleLog(bytes.data(), bytes.size(), log)) {
+        fprintf(stderr, "Not a battle log\n");
+        return 2;
+    }
+
+    printf("Round %u battle\n", log.round);
+    printTeam("A", log.teams[0]);
+    printTeam("B", log.teams[1]);
+    printEvents(log);
+
+    // Run the battle again from the recorded state and compare the attacks
+    BattleTeam team1 = log.teams[0], team2 = log.teams[1];
+    GamesRandom rng;
+    rng.restore(log.rng);
+    BattleLog replay = {};
+    BattleResult result = runBattle(team1, team2, elfDodge, &rng, &replay);
+
+    bool same = replay.eventCount == log.eventCount && replay.truncated == log.truncated;
+    for (int i = 0; same && i < log.eventCount; i++)
+        same = replay.events[i] == log.events[i];
+
+    printf("Result: %s wins after %u rounds, A lost %d health, B lost %d health\n", result.team1Won ? "A" : "B",
+           result.rounds, result.healthLost[0], result.healthLost[1]);
+    printf("Replay %s the log\n", same ? "matches" : "DOES NOT match");
+    return same ? 0 : 1;
+}
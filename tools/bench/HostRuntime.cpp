@@ -0,0 +1,88 @@
+#include "HostRuntime.h"
+#include "MeshService.h"
+#include "configuration.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+HostCounters hostCounters;
+uint64_t hostClockMs = 0;
+uint64_t hostRandomState = 1;
+bool hostVerbose = false;
+void (*hostOnSend)(const meshtastic_MeshPacket &p) = nullptr;
+
+uint32_t millis()
+{
+    return static_cast<uint32_t>(hostClockMs);
+}
+
+long random(long max)
+{
+    hostRandomState = hostRandomState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return max > 0 ? static_cast<long>((hostRandomState >> 33) % static_cast<uint64_t>(max)) : 0;
+}
+
+long random(long min, long max)
+{
+    return min + random(max - min);
+}
+
+void hostLog(const char *format, ...)
+{
+    if (!hostVerbose)
+        return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+// Packets come from the firmware's static pool, so they are not heap traffic
+meshtastic_MeshPacket *hostAllocPacket()
+{
+    return new (malloc(sizeof(meshtastic_MeshPacket))) meshtastic_MeshPacket();
+}
+
+static MeshService hostService;
+MeshService *service = &hostService;
+
+void MeshService::sendToMesh(meshtastic_MeshPacket *p, RxSource, bool)
+{
+    hostCounters.packets++;
+    hostCounters.bytes += p->decoded.payload.size;
+    if (hostVerbose) {
+        fprintf(stderr, "  -> %08x port %d:", (unsigned)p->to, (int)p->decoded.portnum);
+        if (p->decoded.portnum == GAMES_BINARY_PORTNUM) {
+            for (size_t i = 0; i < p->decoded.payload.size; i++)
+                fprintf(stderr, " %02x", p->decoded.payload.bytes[i]);
+            fprintf(stderr, "\n");
+        } else {
+            fprintf(stderr, " %.*s\n", (int)p->decoded.payload.size, reinterpret_cast<const char *>(p->decoded.payload.bytes));
+        }
+    }
+    if (hostOnSend)
+        hostOnSend(*p);
+    free(p);
+}
+
+// Counts every heap allocation the module makes. Kept out of line so the
+// compiler does not pair the inlined malloc/free against new/delete.
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    hostCounters.allocs++;
+    hostCounters.allocBytes += size;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
@@ -0,0 +1,26 @@
+#pragma once
+// Host implementations of what the stub headers declare, shared by the
+// benchmark and the tests: a virtual clock, a seeded random(), a counting
+// operator new and a sendToMesh that counts and frees packets.
+#include "GamesModule.h"
+#include <cstdint>
+
+struct HostCounters {
+    uint64_t allocs = 0;
+    uint64_t allocBytes = 0;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+};
+
+extern HostCounters hostCounters;
+extern uint64_t hostClockMs;      // What millis() returns
+extern uint64_t hostRandomState;  // Seed for random()
+extern bool hostVerbose;          // Print logs and sent packets to stderr
+
+// Called with every packet handed to sendToMesh, before it is freed
+extern void (*hostOnSend)(const meshtastic_MeshPacket &p);
+
+// GamesModule with its protected entry point exposed
+struct HostGamesModule : GamesModule {
+    using GamesModule::handleReceived;
+};
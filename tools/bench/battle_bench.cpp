@@ -0,0 +1,163 @@
+// Micro-benchmark for the AutoChess battle kernels. Every pair of unit types
+// fields three copies each and fights seeded battles through runBattle and
+// through runBattleBatch, as balance_sim does. The tool fails if the kernels
+// ever disagree on a result or leave a battle's random stream in a different
+// state, and --baseline fails when the batch kernel is no faster than the
+// scalar one.
+//
+// Build and run from the repository root (add -mavx2 for the AVX2 kernel):
+//   g++ -std=c++17 -O2 -I. -o battle_bench tools/bench/battle_bench.cpp AutoChessBattle.cpp AutoChessBattleBatch.cpp
+//   ./battle_bench --baseline tools/bench/baselines.txt
+//
+// Usage:
+//   battle_bench [--battles N] [--baseline FILE]
+
+#include "AutoChessBattle.h"
+#include "AutoChessBattleBatch.h"
+#include "GamesRandom.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct Matchup {
+    BattleTeam team1, team2;
+};
+
+static BattleTeam monoTeam(int templateId, int enemyId)
+{
+    AutoChessUnit units[3];
+    AutoChessSynergies own = {}, enemy = {};
+    for (int i = 0; i < 3; i++) {
+        const auto &info = UNIT_TEMPLATES[templateId];
+        units[i] = {static_cast<uint8_t>(templateId), 1, info.health, info.mana};
+        own.add(info);
+        enemy.add(UNIT_TEMPLATES[enemyId]);
+    }
+    BattleTeam team;
+    fillBattleTeam(team, units, 3, own, enemy);
+    return team;
+}
+
+// Each battle's outcome and where it left its random stream
+struct Outcome {
+    BattleResult result;
+    uint64_t rng[2];
+};
+
+static bool sameOutcome(const Outcome &a, const Outcome &b)
+{
+    return a.result.team1Won == b.result.team1Won && a.result.rounds == b.result.rounds &&
+           a.result.healthLost[0] == b.result.healthLost[0] && a.result.healthLost[1] == b.result.healthLost[1] &&
+           a.rng[0] == b.rng[0] && a.rng[1] == b.rng[1];
+}
+
+// Fights every matchup battles times, returning M battles per second
+template <typename Fight>
+static double timeKernel(const std::vector<Matchup> &matchups, int battles, std::vector<Outcome> &outcomes,
+                         Fight fight)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t m = 0; m < matchups.size(); m++)
+        fight(matchups[m], m, &outcomes[m * battles]);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(matchups.size()) * battles / seconds / 1e6;
+}
+
+// The speedup recorded for this kernel, from a "battle_kernel KERNEL SPEEDUP" line
+static double readBaseline(const char *path, const char *kernel)
+{
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+    char line[128], name[32];
+    double speedup = 0, value;
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "battle_kernel %31s %lf", name, &value) == 2 && !strcmp(name, kernel))
+            speedup = value;
+    }
+    fclose(in);
+    return speedup;
+}
+
+int main(int argc, char **argv)
+{
+    int battles = 20000;
+    const char *baselinePath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--battles") == 0 && i + 1 < argc) {
+            battles = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--battles N] [--baseline FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (battles < 1)
+        battles = 1;
+
+    std::vector<Matchup> matchups;
+    for (int a = 0; a < UNIT_TEMPLATES_COUNT; a++) {
+        for (int b = 0; b < UNIT_TEMPLATES_COUNT; b++)
+            matchups.push_back({monoTeam(a, b), monoTeam(b, a)});
+    }
+
+    std::vector<Outcome> scalar(matchups.size() * battles), batched(matchups.size() * battles);
+    double scalarRate = timeKernel(matchups, battles, scalar, [&](const Matchup &m, size_t cell, Outcome *out) {
+        for (int i = 0; i < battles; i++) {
+            GamesRandom rng;
+            rng.seed(1, (uint64_t(cell) << 32) | i);
+            BattleTeam team1 = m.team1, team2 = m.team2;
+            out[i].result = runBattle(team1, team2, elfDodge, &rng);
+            rng.save(out[i].rng);
+        }
+    });
+    double batchRate = timeKernel(matchups, battles, batched, [&](const Matchup &m, size_t cell, Outcome *out) {
+        BattleBatch batch;
+        GamesRandom rngs[BATTLE_BATCH_LANES];
+        BattleResult results[BATTLE_BATCH_LANES];
+        for (int first = 0; first < battles; first += BATTLE_BATCH_LANES) {
+            batch.clear();
+            int lanes = battles - first < BATTLE_BATCH_LANES ? battles - first : BATTLE_BATCH_LANES;
+            for (int lane = 0; lane < lanes; lane++) {
+                rngs[lane].seed(1, (uint64_t(cell) << 32) | (first + lane));
+                batch.setLane(lane, m.team1, m.team2, &rngs[lane]);
+            }
+            runBattleBatch(batch, results);
+            for (int lane = 0; lane < lanes; lane++) {
+                out[first + lane].result = results[lane];
+                rngs[lane].save(out[first + lane].rng);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < scalar.size(); i++) {
+        if (!sameOutcome(scalar[i], batched[i])) {
+            fprintf(stderr, "Kernels disagree on battle %zu of matchup %zu\n", i % battles, i / battles);
+            return 1;
+        }
+    }
+
+    double speedup = batchRate / scalarRate;
+    printf("%zu matchups x %d battles\n", matchups.size(), battles);
+    printf("%-8s %14s\n", "kernel", "M battles/s");
+    printf("%-8s %14.2f\n", "scalar", scalarRate);
+    printf("%-8s %14.2f\n", battleBatchKernel(), batchRate);
+    printf("battle_kernel %s %.2f\n", battleBatchKernel(), speedup);
+    if (!baselinePath)
+        return 0;
+
+    // The speedup depends on the machine, so only losing to scalar fails
+    double expected = readBaseline(baselinePath, battleBatchKernel());
+    if (expected == 0)
+        printf("%s: no baseline\n", battleBatchKernel());
+    else if (speedup < expected * 0.8)
+        printf("%s: warning: speedup %.2f, baseline %.2f\n", battleBatchKernel(), speedup, expected);
+    bool ok = speedup > 1;
+    printf(ok ? "Baseline check passed\n" : "Baseline check FAILED, the batch kernel is slower than scalar\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+// Host benchmark for GamesModule. Builds the module against the stand-ins in
+// tools/bench/stubs, replays scripted packet streams through handleReceived
+// on a virtual clock and reports, per command: latency percentiles, heap
+// allocations, and packets and payload bytes sent. Replies queued for the
+// scheduler thread show up under "(scheduler)", which also covers AutoChess
+// rounds and their battles.
+//
+// Build from the repository root:
+//   g++ -std=gnu++17 -O2 -Itools/bench/stubs -I. -o games_bench tools/bench/games_bench.cpp
+//       tools/bench/HostRuntime.cpp GamesModule.cpp AutoChessBattle.cpp
+// Add -DARCH_PORTDUINO=1 -DHANGMAN_DICTIONARY_PATH='"words.bin"' for the portduino build
+// with the mapped Hangman dictionary.
+//
+// Usage:
+//   games_bench [--copies N] [--repeat R] [--gap MS] [--seed S] [--airtime PERMILLE] [--verbose]
+//               [--baseline FILE | --write-baseline FILE] SCENARIO...
+//
+// A scenario is a text file, one step per line:
+//   A t new       player A sends "t new" on the text port
+//   bA t 5        player A sends "t 5" on the binary port, after GAMES_BINARY_MAGIC
+//   +30           advance the clock 30 s, running the scheduler every second
+// Players are letters; each of the --copies interleaved copies of the script
+// (and each --repeat) gets its own nodes, so the copies play concurrently.
+// The airtime budget is off unless --airtime sets one, so every reply is sent
+// once its coalescing window closes.
+//
+// Packets and bytes depend only on the script and seed, heap allocations also
+// on the standard library. --baseline fails when any of them grows more than
+// 2% over the baseline and warns when median or p99 latency grows more than
+// 50%. To check a change against the checked-in baselines:
+//   games_bench tools/bench/scenarios/*.txt --baseline tools/bench/baselines.txt
+
+#include "HostRuntime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Scenario scripts
+
+struct Step {
+    int advanceSeconds;  // Clock step when nonzero, otherwise a packet
+    char player;
+    bool binary;
+    std::string text;
+};
+
+struct Scenario {
+    std::string name;
+    std::vector<Step> steps;
+};
+
+static bool loadScenario(const char *path, Scenario &scenario)
+{
+    std::ifstream in(path);
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    std::string name = path;
+    name = name.substr(name.find_last_of('/') + 1);
+    scenario.name = name.substr(0, name.find('.'));
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        Step step = {};
+        if (line[0] == '+') {
+            step.advanceSeconds = atoi(line.c_str() + 1);
+        } else {
+            size_t at = 0;
+            step.binary = line[0] == 'b';
+            if (step.binary)
+                at++;
+            size_t space = line.find(' ', at);
+            if (space != at + 1 || line[at] < 'A' || line[at] > 'Z') {
+                fprintf(stderr, "%s:%d: expected \"[b]<player> <text>\"\n", path, lineNumber);
+                return false;
+            }
+            step.player = line[at];
+            step.text = line.substr(space + 1);
+        }
+        scenario.steps.push_back(step);
+    }
+    return true;
+}
+
+// Groups commands the way dispatch does: game, verb, and single characters as "?"
+static std::string commandKey(const std::string &text)
+{
+    std::string key;
+    size_t at = 0;
+    for (int token = 0; token < 2; token++) {
+        size_t start = text.find_first_not_of(' ', at);
+        if (start == std::string::npos)
+            break;
+        size_t end = std::min(text.find(' ', start), text.size());
+        std::string word = text.substr(start, end - start);
+        if (!key.empty())
+            key += ' ';
+        key += word.size() == 1 && token > 0 ? "?" : word;
+        at = end;
+    }
+    return key;
+}
+
+// Measurements
+
+struct CommandStats {
+    std::vector<uint32_t> nanos;
+    HostCounters counters;
+};
+
+struct Summary {
+    uint64_t commands = 0;
+    HostCounters counters;
+    double p50Us = 0;
+    double p99Us = 0;
+};
+
+static double percentileUs(std::vector<uint32_t> &nanos, double fraction)
+{
+    if (nanos.empty())
+        return 0;
+    size_t index = std::min(nanos.size() - 1, static_cast<size_t>(fraction * nanos.size()));
+    std::nth_element(nanos.begin(), nanos.begin() + index, nanos.end());
+    return nanos[index] / 1000.0;
+}
+
+static void addCounters(HostCounters &total, const HostCounters &before, const HostCounters &after)
+{
+    total.allocs += after.allocs - before.allocs;
+    total.allocBytes += after.allocBytes - before.allocBytes;
+    total.packets += after.packets - before.packets;
+    total.bytes += after.bytes - before.bytes;
+}
+
+struct Options {
+    int copies = 8;
+    int repeat = 4;
+    int gapMs = 50;
+    uint64_t seed = 1;
+    int airtimePermille = 0;  // Off, so replies are not held back by the radio budget
+};
+
+static Summary runScenario(const Scenario &scenario, const Options &options)
+{
+    hostClockMs = 0;
+    hostRandomState = options.seed;
+    auto module = new HostGamesModule();
+    module->setAirtimeBudget(options.airtimePermille, 60000);
+
+    std::map<std::string, CommandStats> stats;
+    CommandStats &scheduler = stats["(scheduler)"];
+    auto tick = [&](uint64_t ms) {
+        hostClockMs += ms;
+        HostCounters before = hostCounters;
+        auto start = std::chrono::steady_clock::now();
+        concurrency::OSThread::runDue(millis());
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        if (hostCounters.packets != before.packets || hostCounters.allocs != before.allocs) {
+            scheduler.nanos.push_back(static_cast<uint32_t>(nanos.count()));
+            addCounters(scheduler.counters, before, hostCounters);
+        }
+    };
+
+    for (int round = 0; round < options.repeat; round++) {
+        for (const Step &step : scenario.steps) {
+            if (step.advanceSeconds) {
+                for (int i = 0; i < step.advanceSeconds; i++)
+                    tick(1000);
+                continue;
+            }
+            CommandStats &command = stats[commandKey(step.text)];
+            for (int copy = 0; copy < options.copies; copy++) {
+                meshtastic_MeshPacket packet = {};
+                packet.from = 0x10000 + ((round * options.copies + copy) << 5) + (step.player - 'A');
+                packet.to = NODENUM_BROADCAST;
+                packet.decoded.portnum = step.binary ? GAMES_BINARY_PORTNUM : meshtastic_PortNum_TEXT_MESSAGE_APP;
+                std::string payload = step.binary ? char(GAMES_BINARY_MAGIC) + step.text : step.text;
+                packet.decoded.payload.size = std::min(payload.size(), sizeof(packet.decoded.payload.bytes));
+                memcpy(packet.decoded.payload.bytes, payload.data(), packet.decoded.payload.size);
+                if (hostVerbose)
+                    fprintf(stderr, "%08x%s: %s\n", (unsigned)packet.from, step.binary ? " (binary)" : "", step.text.c_str());
+
+                HostCounters before = hostCounters;
+                auto start = std::chrono::steady_clock::now();
+                if (step.binary)
+                    module->handleBinaryReceived(packet);
+                else
+                    module->handleReceived(packet);
+                auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                command.nanos.push_back(static_cast<uint32_t>(nanos.count()));
+                addCounters(command.counters, before, hostCounters);
+                tick(options.gapMs);
+            }
+        }
+    }
+    delete module;
+
+    printf("%s: %d copies x %d repeats\n", scenario.name.c_str(), options.copies, options.repeat);
+    printf("  %-14s %7s %8s %8s %8s %8s %9s %9s %7s %8s\n", "command", "count", "p50 us", "p90 us", "p99 us",
+           "max us", "allocs", "alloc B", "packets", "bytes");
+    Summary summary;
+    std::vector<uint32_t> all;
+    for (auto &entry : stats) {
+        CommandStats &command = entry.second;
+        if (command.nanos.empty())
+            continue;
+        size_t count = command.nanos.size();
+        double p50 = percentileUs(command.nanos, 0.50);
+        double p90 = percentileUs(command.nanos, 0.90);
+        double p99 = percentileUs(command.nanos, 0.99);
+        double max = *std::max_element(command.nanos.begin(), command.nanos.end()) / 1000.0;
+        printf("  %-14s %7zu %8.2f %8.2f %8.2f %8.2f %9.1f %9.1f %7llu %8llu\n", entry.first.c_str(), count, p50, p90,
+               p99, max, double(command.counters.allocs) / count, double(command.counters.allocBytes) / count,
+               (unsigned long long)command.counters.packets, (unsigned long long)command.counters.bytes);
+
+        if (&command != &scheduler) {
+            summary.commands += count;
+            all.insert(all.end(), command.nanos.begin(), command.nanos.end());
+        }
+        summary.counters.allocs += command.counters.allocs;
+        summary.counters.allocBytes += command.counters.allocBytes;
+        summary.counters.packets += command.counters.packets;
+        summary.counters.bytes += command.counters.bytes;
+    }
+    summary.p50Us = percentileUs(all, 0.50);
+    summary.p99Us = percentileUs(all, 0.99);
+    printf("  total: %llu commands, p50 %.2f us, p99 %.2f us, %llu allocs (%llu B), %llu packets (%llu B)\n\n",
+           (unsigned long long)summary.commands, summary.p50Us, summary.p99Us,
+           (unsigned long long)summary.counters.allocs, (unsigned long long)summary.counters.allocBytes,
+           (unsigned long long)summary.counters.packets, (unsigned long long)summary.counters.bytes);
+    return summary;
+}
+
+// Baselines: one line per scenario, "name commands allocs allocBytes packets bytes p50Us p99Us"
+
+static std::map<std::string, Summary> readBaselines(const char *path)
+{
+    std::map<std::string, Summary> baselines;
+    std::ifstream in(path);
+    if (!in)
+        perror(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        char name[64];
+        unsigned long long values[5];
+        double p50, p99;
+        if (sscanf(line.c_str(), "%63s %llu %llu %llu %llu %llu %lf %lf", name, &values[0], &values[1], &values[2],
+                   &values[3], &values[4], &p50, &p99) != 8)
+            continue;
+        Summary &summary = baselines[name];
+        summary.commands = values[0];
+        summary.counters = {values[1], values[2], values[3], values[4]};
+        summary.p50Us = p50;
+        summary.p99Us = p99;
+    }
+    return baselines;
+}
+
+static bool writeBaselines(const char *path, const std::map<std::string, Summary> &results)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    fprintf(out, "# scenario commands allocs allocBytes packets bytes p50Us p99Us\n");
+    for (const auto &entry : results) {
+        const Summary &s = entry.second;
+        fprintf(out, "%s %llu %llu %llu %llu %llu %.2f %.2f\n", entry.first.c_str(), (unsigned long long)s.commands,
+                (unsigned long long)s.counters.allocs, (unsigned long long)s.counters.allocBytes,
+                (unsigned long long)s.counters.packets, (unsigned long long)s.counters.bytes, s.p50Us, s.p99Us);
+    }
+    fclose(out);
+    return true;
+}
+
+// Counters may not grow more than 2%; latency only warns, it depends on the machine
+static bool checkBaseline(const std::string &name, const Summary &result, const Summary &baseline)
+{
+    bool ok = true;
+    auto counter = [&](const char *what, uint64_t value, uint64_t expected) {
+        if (value * 100 > expected * 102) {
+            printf("%s: REGRESSION %s %llu, baseline %llu\n", name.c_str(), what, (unsigned long long)value,
+                   (unsigned long long)expected);
+            ok = false;
+        } else if (value < expected) {
+            printf("%s: %s down to %llu from %llu, consider updating the baseline\n", name.c_str(), what,
+                   (unsigned long long)value, (unsigned long long)expected);
+        }
+    };
+    auto latency = [&](const char *what, double value, double expected) {
+        if (value > expected * 1.5)
+            printf("%s: warning: %s %.2f us, baseline %.2f us\n", name.c_str(), what, value, expected);
+    };
+
+    if (result.commands != baseline.commands)
+        printf("%s: warning: %llu commands, baseline has %llu; the options or script differ\n", name.c_str(),
+               (unsigned long long)result.commands, (unsigned long long)baseline.commands);
+    counter("allocs", result.counters.allocs, baseline.counters.allocs);
+    counter("alloc bytes", result.counters.allocBytes, baseline.counters.allocBytes);
+    counter("packets", result.counters.packets, baseline.counters.packets);
+    counter("bytes", result.counters.bytes, baseline.counters.bytes);
+    latency("p50", result.p50Us, baseline.p50Us);
+    latency("p99", result.p99Us, baseline.p99Us);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    const char *baselinePath = nullptr;
+    const char *writePath = nullptr;
+    std::vector<Scenario> scenarios;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--verbose"))
+            hostVerbose = true;
+        else if (!strcmp(argv[i], "--copies") && hasValue)
+            options.copies = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--repeat") && hasValue)
+            options.repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--gap") && hasValue)
+            options.gapMs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--airtime") && hasValue)
+            options.airtimePermille = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--baseline") && hasValue)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--write-baseline") && hasValue)
+            writePath = argv[++i];
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        } else {
+            scenarios.emplace_back();
+            if (!loadScenario(argv[i], scenarios.back()))
+                return 2;
+        }
+    }
+    if (scenarios.empty() || options.copies < 1 || options.copies > 64 || options.repeat < 1) {
+        fprintf(stderr, "Need at least one scenario, --copies 1-64 and --repeat at least 1\n");
+        return 2;
+    }
+
+    std::map<std::string, Summary> results;
+    for (const Scenario &scenario : scenarios)
+        results[scenario.name] = runScenario(scenario, options);
+
+    if (writePath)
+        return writeBaselines(writePath, results) ? 0 : 1;
+    if (baselinePath) {
+        auto baselines = readBaselines(baselinePath);
+        bool ok = true;
+        for (const auto &entry : results) {
+            auto baseline = baselines.find(entry.first);
+            if (baseline == baselines.end())
+                printf("%s: no baseline\n", entry.first.c_str());
+            else
+                ok &= checkBaseline(entry.first, entry.second, baseline->second);
+        }
+        printf(ok ? "Baseline check passed\n" : "Baseline check FAILED\n");
+        return ok ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,866 @@
+// Host tests for GamesModule, built against the same stand-ins as the
+// benchmark. Each test drives a fresh module on the virtual clock and checks
+// what reaches sendToMesh.
+//
+// Build and run from the repository root:
+//   g++ -std=gnu++17 -O2 -Itools/bench/stubs -I. -o games_test tools/bench/games_test.cpp
+//       tools/bench/HostRuntime.cpp GamesModule.cpp AutoChessBattle.cpp && ./games_test
+// Add -DARCH_PORTDUINO=1 -DHANGMAN_DICTIONARY_PATH='"games_test.dict"' to also
+// test the mapped Hangman dictionary; the test writes that file itself.
+
+#include "HostRuntime.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                              \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+// Fixed size, so recording a packet does not count against the module
+struct Sent {
+    uint32_t to;
+    bool binary;
+    uint16_t length;
+    char text[meshtastic_Constants_DATA_PAYLOAD_LEN];
+};
+
+static std::vector<Sent> sent;
+
+static void recordSent(const meshtastic_MeshPacket &p)
+{
+    Sent s;
+    s.to = p.to;
+    s.binary = p.decoded.portnum == GAMES_BINARY_PORTNUM;
+    s.length = p.decoded.payload.size;
+    memcpy(s.text, p.decoded.payload.bytes, s.length);
+    sent.push_back(s);
+}
+
+// A fresh module on a clock starting at zero, with the airtime budget off
+struct Fixture {
+    std::unique_ptr<HostGamesModule> module;
+
+    Fixture()
+    {
+        hostClockMs = 0;
+        hostRandomState = 1;
+        hostOnSend = recordSent;
+        sent.clear();
+        sent.reserve(4096);
+        module.reset(new HostGamesModule());
+        module->setAirtimeBudget(0, 0);
+    }
+
+    // Binary requests carry the protocol's magic byte ahead of the text
+    ProcessMessage receive(uint32_t from, const std::string &text, bool binary = false)
+    {
+        return deliver(from, binary ? char(GAMES_BINARY_MAGIC) + text : text, binary);
+    }
+
+    // A packet with exactly this payload on the text or binary port. hops < 0
+    // leaves hop_start unset, as from firmware that does not report it.
+    ProcessMessage deliver(uint32_t from, const std::string &payload, bool binary, int hops = -1)
+    {
+        meshtastic_MeshPacket packet = {};
+        packet.from = from;
+        packet.to = NODENUM_BROADCAST;
+        if (hops >= 0) {
+            packet.hop_start = 3;
+            packet.hop_limit = 3 - hops;
+        }
+        packet.decoded.portnum = binary ? GAMES_BINARY_PORTNUM : meshtastic_PortNum_TEXT_MESSAGE_APP;
+        packet.decoded.payload.size = payload.size();
+        memcpy(packet.decoded.payload.bytes, payload.data(), payload.size());
+        return binary ? module->handleBinaryReceived(packet) : module->handleReceived(packet);
+    }
+
+    // Runs the scheduler thread every 50 ms of virtual time
+    void advance(uint32_t ms)
+    {
+        for (uint32_t step = 0; step < ms; step += 50) {
+            hostClockMs += 50;
+            concurrency::OSThread::runDue(millis());
+        }
+    }
+
+    // Text of everything sent to one node, in order
+    std::vector<std::string> sentTo(uint32_t node) const
+    {
+        std::vector<std::string> texts;
+        for (const Sent &s : sent) {
+            if (s.to == node)
+                texts.emplace_back(s.text, s.length);
+        }
+        return texts;
+    }
+};
+
+static void testChatIsNotACommand()
+{
+    Fixture f;
+    CHECK(f.receive(1, "help me with my radio") == ProcessMessage::CONTINUE);
+    CHECK(f.receive(1, "games are fun") == ProcessMessage::CONTINUE);
+    CHECK(f.receive(1, "h a lot of fun") == ProcessMessage::CONTINUE);
+    CHECK(f.receive(1, "t board please") == ProcessMessage::CONTINUE);
+    f.advance(1000);
+    CHECK(sent.empty());
+
+    CHECK(f.receive(1, "help") == ProcessMessage::STOP);
+    CHECK(f.receive(2, "t board ") == ProcessMessage::STOP);
+    f.advance(1000);
+    CHECK(!f.sentTo(1).empty());
+    CHECK(f.sentTo(2).size() == 1);
+}
+
+// Chat starting with a module verb is turned away before dispatch
+static void testChatStartingWithAVerbIsRejectedEarly()
+{
+    Fixture f;
+    const char *chat[] = {"help me with my radio", "gamestats please", "games tonight?"};
+    for (const char *text : chat)
+        CHECK(f.receive(1, text) == ProcessMessage::CONTINUE);
+    CHECK(f.receive(1, "gamestats") == ProcessMessage::STOP);
+    f.advance(1000);
+    std::vector<std::string> replies = f.sentTo(1);
+    CHECK(!replies.empty());
+    // gamestats reports the rejected messages; all three count
+    bool counted = false;
+    for (const std::string &reply : replies)
+        counted |= reply.find("Rejected: 3") != std::string::npos;
+    CHECK(counted);
+}
+
+// The binary port carries only commands, so junk on it is not counted as chat,
+// frames without the magic byte are not ours, and a node is answered in the
+// protocol of its last command
+static void testBinaryPortPreference()
+{
+    Fixture f;
+    CHECK(f.receive(1, "zzz", true) == ProcessMessage::CONTINUE);
+    CHECK(f.receive(1, "hello there") == ProcessMessage::CONTINUE);
+    // Another private app's frame on the shared port, even one that reads
+    // like a command, is left alone
+    CHECK(f.deliver(1, "h new", true) == ProcessMessage::CONTINUE);
+    f.advance(1000);
+    CHECK(sent.empty());
+    CHECK(f.receive(1, "h new", true) == ProcessMessage::STOP);
+    f.advance(1000);
+    CHECK(!sent.empty() && sent.back().binary);
+
+    sent.clear();
+    CHECK(f.receive(1, "gamestats") == ProcessMessage::STOP);
+    f.advance(1000);
+    bool counted = false;
+    for (const Sent &s : sent) {
+        CHECK(!s.binary);
+        counted |= std::string(s.text, s.length).find("Rejected: 1 msgs") != std::string::npos;
+    }
+    CHECK(counted);
+}
+
+static bool sentContains(const Fixture &f, uint32_t node, const char *text)
+{
+    for (const std::string &reply : f.sentTo(node)) {
+        if (reply.find(text) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+// Joins take the oldest open game that passes the hop filter; games leave the
+// lobby once they are full or time out
+static void testLobbyMatchesOldestOpenGame()
+{
+    Fixture f;
+    f.deliver(1, "t new", false, 2);
+    f.deliver(2, "t new", false, 0);
+    f.deliver(6, "t new", false, 0);
+    f.advance(1000);
+
+    // Only node 2 and 6 are direct; node 2 is older
+    f.receive(3, "t join 1");
+    f.advance(1000);
+    CHECK(sentContains(f, 2, "Opponent joined!"));
+    CHECK(!sentContains(f, 1, "Opponent joined!"));
+
+    // Without a filter the oldest open game is node 1's
+    f.receive(4, "t join");
+    f.advance(1000);
+    CHECK(sentContains(f, 1, "Opponent joined!"));
+
+    // Node 6's game times out and leaves the lobby
+    f.advance(600000);
+    f.receive(5, "t join");
+    f.advance(1000);
+    CHECK(!sentContains(f, 6, "Opponent joined!"));
+    CHECK(sentContains(f, 5, "No games available"));
+
+    // AutoChess fills the oldest game up to AUTOCHESS_MAX_PLAYERS first
+    f.receive(10, "ac new");
+    f.advance(300);
+    f.receive(11, "ac new");
+    f.advance(300);
+    for (uint32_t node = 12; node < 10 + AUTOCHESS_MAX_PLAYERS + 2; node++) {
+        f.receive(node, "ac join");
+        f.advance(300);
+    }
+    for (uint32_t node = 12; node < 10 + AUTOCHESS_MAX_PLAYERS + 2; node++) {
+        // Seats 2 to 4 of node 10's game, then seat 2 of node 11's
+        char players[32];
+        snprintf(players, sizeof(players), "Players: %u/%zu", node <= 10 + AUTOCHESS_MAX_PLAYERS ? node - 10 : 2,
+                 AUTOCHESS_MAX_PLAYERS);
+        CHECK(sentContains(f, node, players));
+    }
+    CHECK(sentContains(f, 11, "Game is starting"));
+}
+
+// After a command only what changed is sent, numbered so the client can spot a
+// gap; 'ac state' sends everything again
+static void testAutoChessUpdatesAreDeltas()
+{
+    Fixture f;
+    f.receive(1, "ac new");
+    f.advance(1000);
+
+    sent.clear();
+    f.receive(1, "ac buy 0");
+    f.advance(1000);
+    std::vector<std::string> replies = f.sentTo(1);
+    CHECK(replies.size() == 1);
+    std::string bought;
+    if (replies.size() == 1) {
+        const std::string &reply = replies[0];
+        CHECK(reply.find("Unit purchased! #2\ngold 5>") == 0);
+        CHECK(reply.find(", shop -0, bench +") != std::string::npos);
+        CHECK(reply.find("Shop:") == std::string::npos);
+        bought = reply.substr(reply.find("bench +") + 7);
+    }
+
+    sent.clear();
+    f.receive(1, "ac place 0 0");
+    f.advance(1000);
+    replies = f.sentTo(1);
+    CHECK(replies.size() == 1 && replies[0] == "Unit placed! #3\nbench -0, board +" + bought);
+
+    sent.clear();
+    f.receive(1, "ac state");
+    f.advance(1000);
+    CHECK(sentContains(f, 1, "Sync #4"));
+    CHECK(sentContains(f, 1, "Shop:"));
+}
+
+// Binary clients get game state as compact BinaryReply messages and
+// everything else as text, both on the binary port
+static void testBinaryRepliesCarryGameState()
+{
+    Fixture f;
+    // The one reply to node, empty unless it came on the binary port
+    auto only = [](uint32_t node) {
+        std::string reply;
+        int count = 0;
+        for (const Sent &s : sent) {
+            if (s.to == node) {
+                reply = s.binary ? std::string(s.text, s.length) : std::string();
+                count++;
+            }
+        }
+        return count == 1 ? reply : std::string();
+    };
+    auto bytes = [](std::initializer_list<uint8_t> values) { return std::string(values.begin(), values.end()); };
+
+    f.receive(1, "t new", true);
+    f.advance(1000);
+    CHECK(only(1).find("New Tic Tac Toe game started!") == 0);
+
+    // TicTacToe: kind, status, X mask, O mask, your mark
+    sent.clear();
+    f.receive(2, "t join", true);
+    f.advance(1000);
+    CHECK(only(2) == bytes({1, uint8_t(BinaryStatus::OpponentTurn), 0, 0, 'O'}));
+    CHECK(only(1) == bytes({1, uint8_t(BinaryStatus::YourTurn), 0, 0, 'X'}));
+
+    sent.clear();
+    f.receive(1, "t 5", true);
+    f.advance(1000);
+    CHECK(only(1) == bytes({1, uint8_t(BinaryStatus::OpponentTurn), 1 << 4, 0, 'X'}));
+    CHECK(only(2) == bytes({1, uint8_t(BinaryStatus::YourTurn), 1 << 4, 0, 'O'}));
+
+    // Hangman: kind, status, remaining guesses, guessed mask, length, letters
+    sent.clear();
+    f.receive(3, "h new", true);
+    f.advance(1000);
+    std::string hangman = only(3);
+    CHECK(hangman.size() > 5 && hangman.compare(0, 4, bytes({2, uint8_t(BinaryStatus::Playing), 6, 0})) == 0 &&
+          hangman.size() == 5u + uint8_t(hangman[4]) && hangman.find_first_not_of('_', 5) == std::string::npos);
+}
+
+#if ARCH_PORTDUINO
+// Writes a dictionary in the layout bin/build-hangman-dict.py produces.
+// words[d] holds the words of difficulty d, each bucket already sorted.
+static bool writeHangmanDictionary(const char *path, const std::vector<std::string> words[3],
+                                   const char *magic = "HMD1")
+{
+    const int lengths = HangmanDictionary::MAX_LENGTH + 1, levels = HangmanDictionary::DIFFICULTIES;
+    std::string table, body;
+    for (int length = 0; length < lengths; length++) {
+        for (int level = 0; level < levels; level++) {
+            uint32_t bucket[2] = {uint32_t(8 + 8 * lengths * levels + body.size()), 0};
+            for (const std::string &word : words[level]) {
+                if (int(word.size()) == length) {
+                    body += word;
+                    bucket[1]++;
+                }
+            }
+            table.append(reinterpret_cast<const char *>(bucket), sizeof(bucket));
+        }
+    }
+    FILE *out = fopen(path, "wb");
+    if (!out)
+        return false;
+    std::string file = std::string(magic, 4) + std::string(4, '\0') + table + body;
+    bool written = fwrite(file.data(), 1, file.size(), out) == file.size();
+    return fclose(out) == 0 && written;
+}
+
+// The dictionary is found by difficulty and index, damaged files are refused,
+// and the module picks its words from the file
+static void testHangmanDictionaryLoads()
+{
+    const char *path = HANGMAN_DICTIONARY_PATH;
+    std::vector<std::string> words[3] = {{"TEAR", "TONE", "STONE"}, {"MOUSE"}, {"ZEBRA"}};
+    CHECK(writeHangmanDictionary(path, words));
+    {
+        HangmanDictionary dictionary;
+        CHECK(dictionary.open(path));
+        CHECK(dictionary.count(0) == 3 && dictionary.count(1) == 1 && dictionary.count(2) == 1);
+        CHECK(dictionary.count(-1) == 5);
+        CHECK(dictionary.word(0, 0) == "TEAR" && dictionary.word(0, 1) == "TONE" && dictionary.word(0, 2) == "STONE");
+        CHECK(dictionary.word(2, 0) == "ZEBRA");
+        CHECK(dictionary.word(-1, 4) == "ZEBRA" && dictionary.word(-1, 5).empty());
+    }
+
+    // Only hard words: every game uses the file's one word
+    std::vector<std::string> zebra[3] = {{}, {}, {"ZEBRA"}};
+    CHECK(writeHangmanDictionary(path, zebra));
+    {
+        Fixture f;
+        f.receive(1, "h new");
+        f.receive(2, "h new easy");
+        f.advance(1000);
+        f.receive(1, "h z");
+        f.advance(1000);
+        CHECK(sentContains(f, 1, "Word: Z _ _ _ _"));
+        CHECK(sentContains(f, 2, "Word: _ _ _ _ _"));
+    }
+
+    HangmanDictionary damaged;
+    CHECK(writeHangmanDictionary(path, words, "HMD0"));
+    CHECK(!damaged.open(path));
+    CHECK(truncate(path, 100) == 0);
+    CHECK(!damaged.open(path));
+    remove(path);
+}
+#endif
+
+// A node that switches back to text frees its slot in the binary client set,
+// and the next binary node takes that slot instead of evicting a live client
+static void testBinaryClientsFillFreeSlotsFirst()
+{
+    Fixture f;
+    CHECK(f.receive(1, "t new", true) == ProcessMessage::STOP);
+    for (uint32_t node = 2; node <= 16; node++)
+        f.receive(node, "gamestats", true);
+    f.receive(5, "gamestats");
+    f.receive(100, "gamestats", true);
+    f.advance(1000);
+
+    sent.clear();
+    CHECK(f.receive(200, "t join") == ProcessMessage::STOP);
+    f.advance(1000);
+    bool notified = false;
+    for (const Sent &s : sent) {
+        if (s.to == 1) {
+            CHECK(s.binary);
+            notified = true;
+        }
+    }
+    CHECK(notified);
+}
+
+static int countTimers(GameTimer *timer)
+{
+    int count = 0;
+    for (; timer; timer = timer->next)
+        count++;
+    return count;
+}
+
+// After a long idle stretch the wheel neither steps through every missed
+// tick nor files new timers against the stale tick
+static void testTimerWheelCatchesUpAfterIdle()
+{
+    TimerWheel wheel;
+    GameTimer a, b, c;
+    wheel.schedule(a, 0, 10);
+    CHECK(wheel.advance(5) == nullptr);
+    CHECK(wheel.advance(10) == &a);
+
+    // Empty for about a century of seconds, then a timer 5 s out
+    const uint32_t later = 3000000000u;
+    wheel.schedule(b, later, later + 5);
+    CHECK(wheel.advance(later + 4) == nullptr);
+    CHECK(wheel.advance(later + 5) == &b);
+
+    // Armed timers and a gap of more than one revolution
+    wheel.schedule(a, later + 10, later + 20);
+    wheel.schedule(b, later + 10, later + 100000);
+    wheel.schedule(c, later + 10, later + 200000);
+    CHECK(countTimers(wheel.advance(later + 150000)) == 2);
+    CHECK(c.armed);
+    CHECK(wheel.advance(later + 199999) == nullptr);
+    CHECK(wheel.advance(later + 200000) == &c);
+}
+
+// Text replies render into the fixed reply buffer and views are cached in a
+// fixed arena: once games exist, answering, viewing, running a round and
+// timing a game out allocate nothing
+static void testRepliesDoNotAllocate()
+{
+    Fixture f;
+    f.receive(1, "ac new");
+    f.receive(2, "ac join");
+    f.receive(3, "ac join");
+    f.receive(4, "t new");
+    f.receive(5, "h new");
+    f.receive(1, "ac buy 0");
+    f.receive(1, "ac place 0 0");
+    f.advance(31000);  // First round: battle and bye
+
+    uint64_t before = hostCounters.allocs;
+    size_t sentBefore = sent.size();
+    f.receive(1, "gamestats");
+    f.receive(1, "help");
+    f.receive(2, "ac status");
+    f.receive(1, "ac log");
+    // Usage and failure replies
+    f.receive(2, "ac buy 99");
+    f.receive(2, "ac sell 7");
+    // Views, rendered and then answered from the cache
+    for (int i = 0; i < 3; i++) {
+        f.receive(4, "t board");
+        f.receive(5, "h state");
+        for (uint32_t player = 1; player <= 3; player++)
+            f.receive(player, "ac state");
+        f.advance(1000);
+    }
+    f.advance(30000);  // Another round
+    CHECK(sent.size() > sentBefore + 9);
+    CHECK(hostCounters.allocs == before);
+
+    // Views again after the round changed the AutoChess boards
+    for (uint32_t player = 1; player <= 3; player++)
+        f.receive(player, "ac state");
+    f.advance(1000);
+    CHECK(hostCounters.allocs == before);
+
+    // Tic Tac Toe timeout notice
+    f.advance(600000);
+    CHECK(hostCounters.allocs == before);
+    CHECK(f.sentTo(4).back().find("timed out") != std::string::npos);
+}
+
+// The hard bot against every line of play open to X: it never loses, and it
+// never passes up a square that wins on the spot
+struct BotSweep {
+    Fixture &f;
+    uint32_t nextNode = 1000;
+    int games = 0, losses = 0, missedWins = 0;
+
+    static uint32_t varint(const std::string &bytes, size_t &at)
+    {
+        uint32_t value = 0;
+        for (int shift = 0; at < bytes.size(); shift += 7) {
+            uint8_t byte = bytes[at++];
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        return value;
+    }
+
+    // Replays moves in a new game; false if the final reply is not a board
+    bool play(const std::vector<int> &moves, BinaryStatus &status, uint16_t &xMask, uint16_t &oMask)
+    {
+        uint32_t node = nextNode++;
+        sent.clear();
+        f.receive(node, "t bot hard", true);
+        for (int square : moves)
+            f.receive(node, std::string("t ") + char('1' + square), true);
+        f.advance(50);
+        std::vector<std::string> replies = f.sentTo(node);
+        if (replies.empty() || replies.back().size() < 5 || replies.back()[0] != char(BinaryReply::TicTacToe))
+            return false;
+        const std::string &reply = replies.back();
+        size_t at = 1;
+        status = BinaryStatus(varint(reply, at));
+        xMask = varint(reply, at);
+        oMask = varint(reply, at);
+        return true;
+    }
+
+    void explore(std::vector<int> &moves)
+    {
+        BinaryStatus status;
+        uint16_t xMask, oMask;
+        if (!play(moves, status, xMask, oMask)) {
+            CHECK(!"no board reply");
+            return;
+        }
+        if (status != BinaryStatus::YourTurn) {
+            games++;
+            losses += status == BinaryStatus::XWins;
+            return;
+        }
+
+        // Squares where O completes a line
+        uint16_t free = ~(xMask | oMask) & 0x1FF, oWins = 0;
+        for (int square = 0; square < 9; square++) {
+            if ((free & (1u << square)) && hasTicTacToeLine(oMask | (1u << square)))
+                oWins |= 1u << square;
+        }
+        for (int square = 0; square < 9; square++) {
+            if (!(free & (1u << square)))
+                continue;
+            moves.push_back(square);
+            if (oWins & ~(1u << square) && !hasTicTacToeLine(xMask | (1u << square))) {
+                BinaryStatus after;
+                uint16_t x, o;
+                if (play(moves, after, x, o) && after != BinaryStatus::OWins)
+                    missedWins++;
+            }
+            explore(moves);
+            moves.pop_back();
+        }
+    }
+};
+
+static void testHardBotPlaysPerfectly()
+{
+    Fixture f;
+    BotSweep sweep{f};
+    std::vector<int> moves;
+    sweep.explore(moves);
+    CHECK(sweep.games > 0);
+    CHECK(sweep.losses == 0);
+    CHECK(sweep.missedWins == 0);
+}
+
+// More viewers than the arena holds: entries are evicted and the arena is
+// compacted, and every answer from the cache matches the rendered view
+static void testRenderCacheSurvivesCompaction()
+{
+    Fixture f;
+    const uint32_t players = 12;
+    for (uint32_t player = 1; player <= players; player++)
+        f.receive(player, "h new");
+    f.advance(1000);
+    for (int pass = 0; pass < 3; pass++) {
+        for (uint32_t player = 1; player <= players; player += 1 + pass) {
+            f.receive(player, "h state");
+            f.advance(300);
+            f.receive(player, "h state");
+            f.advance(300);
+        }
+    }
+    for (uint32_t player = 1; player <= players; player++) {
+        std::vector<std::string> replies = f.sentTo(player);
+        CHECK(replies.size() >= 3);
+        for (size_t i = 2; i < replies.size(); i++)
+            CHECK(replies[i] == replies[1]);
+    }
+}
+
+// Hex lines of one 'ac log' reply joined the way tools/battle_replay does,
+// across the "i/n" headers of its fragments
+static std::string joinLogHex(const std::vector<std::string> &packets)
+{
+    std::string hex;
+    for (const std::string &packet : packets) {
+        size_t start = 0;
+        while (start < packet.size()) {
+            size_t end = packet.find('\n', start);
+            if (end == std::string::npos)
+                end = packet.size();
+            std::string line = packet.substr(start, end - start);
+            if (!line.empty() && line.find_first_not_of("0123456789abcdef") == std::string::npos)
+                hex += line;
+            start = end + 1;
+        }
+    }
+    return hex;
+}
+
+// Every game keeps the logs of its latest round, so many games battling at
+// once do not push each other's logs out, and the text log survives being
+// split into fragments
+static void testBattleLogsArePerGame()
+{
+    Fixture f;
+    const uint32_t games = 6;
+    for (uint32_t g = 0; g < games; g++) {
+        char join[32];
+        snprintf(join, sizeof(join), "ac join %u", 100 + 2 * g);
+        f.receive(100 + 2 * g, "ac new");
+        f.receive(101 + 2 * g, join);
+    }
+
+    // Fill the boards over a few rounds so the later logs need several packets
+    for (int round = 0; round < 6; round++) {
+        for (uint32_t player = 100; player < 100 + 2 * games; player++) {
+            for (int i = 0; i < 3; i++) {
+                char place[32];
+                snprintf(place, sizeof(place), "ac place 0 %d", (round * 3 + i) % 9);
+                f.receive(player, "ac buy 0");
+                f.receive(player, place);
+            }
+        }
+        f.advance(30000);
+    }
+
+    int fragmented = 0;
+    for (uint32_t player = 100; player < 100 + 2 * games; player++) {
+        sent.clear();
+        f.receive(player, "ac log");
+        f.advance(1000);
+        std::vector<std::string> packets = f.sentTo(player);
+        CHECK(!packets.empty() && packets[0].find("No recent battle") == std::string::npos);
+        fragmented += packets.size() > 1;
+
+        std::string hex = joinLogHex(packets);
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2)
+            bytes.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        BattleLog log;
+        CHECK(hex.size() % 2 == 0 && decodeBattleLog(bytes.data(), bytes.size(), log));
+    }
+    CHECK(fragmented > 0);
+}
+
+// 'ac log <round>' reaches back over the last AUTOCHESS_LOG_ROUNDS rounds of
+// a full game; older battles are overwritten
+static void testBattleLogsKeepRecentRounds()
+{
+    Fixture f;
+    f.receive(1, "ac new");
+    for (uint32_t player = 2; player <= AUTOCHESS_MAX_PLAYERS; player++)
+        f.receive(player, "ac join 1");
+    // Rounds 1 to 5
+    f.advance(5 * 30000 + 15000);
+    bool fifth = false;
+    for (const std::string &reply : f.sentTo(1))
+        fifth |= reply.find("Round 5 Battle:") != std::string::npos;
+    CHECK(fifth);
+
+    auto logHeader = [&](const char *command) {
+        sent.clear();
+        f.receive(1, command);
+        f.advance(1000);
+        std::vector<std::string> packets = f.sentTo(1);
+        return packets.empty() ? std::string() : packets[0].substr(0, packets[0].find('\n'));
+    };
+    CHECK(logHeader("ac log") == "Round 5 battle log:");
+    CHECK(logHeader("ac log 5") == "Round 5 battle log:");
+    CHECK(logHeader("ac log 3") == "Round 3 battle log:");
+    CHECK(logHeader("ac log 2") == "No recent battle to show.");
+    CHECK(logHeader("ac log 70000") == "Invalid round. Usage: ac log [round]");
+}
+
+// Short replies to one node within COALESCE_WINDOW_MS share a packet; other
+// nodes and later replies get their own
+static void testRepliesCoalesceWithinTheWindow()
+{
+    Fixture f;
+    f.receive(1, "ac buy 99");
+    f.receive(1, "ac sell -1");
+    f.receive(2, "ac buy 99");
+    f.advance(1000);
+    std::vector<std::string> replies = f.sentTo(1);
+    CHECK(replies.size() == 1 && replies[0] == "Invalid unit index. Usage: ac buy <unit_index>\n\n"
+                                               "Invalid unit index. Usage: ac sell <unit_index>");
+    CHECK(f.sentTo(2).size() == 1);
+
+    sent.clear();
+    f.receive(1, "ac buy 99");
+    f.advance(300);  // Past the 250 ms window
+    f.receive(1, "ac buy 99");
+    f.advance(1000);
+    CHECK(f.sentTo(1).size() == 2);
+
+    sent.clear();
+    f.receive(1, "gamestats");
+    f.advance(1000);
+    CHECK(sentContains(f, 1, "Coalesced: 1 packets saved"));
+}
+
+// A state update still queued is replaced by a newer one for the same game,
+// so the node only gets the latest state
+static void testStateUpdatesSupersedeQueuedOnes()
+{
+    Fixture f;
+    f.receive(1, "h new");
+    f.advance(1000);
+
+    sent.clear();
+    f.receive(1, "h a");
+    f.receive(1, "h e");
+    f.receive(1, "ac buy 99");  // Plain replies are never superseded
+    f.advance(1000);
+    std::vector<std::string> replies = f.sentTo(1);
+    CHECK(replies.size() == 2);
+    CHECK(sentContains(f, 1, "Guessed letters: AE"));
+    CHECK(sentContains(f, 1, "Usage: ac buy"));
+
+    sent.clear();
+    f.receive(1, "gamestats");
+    f.advance(1000);
+    CHECK(sentContains(f, 1, "TX: 1 superseded"));
+}
+
+// Sealed state updates must not overtake an earlier reply still open for
+// coalescing, nor a reply queued earlier at another priority
+static void testRepliesToOneNodeKeepTheirOrder()
+{
+    Fixture f;
+    f.receive(1, "h new");
+    f.receive(1, "h e");
+    f.receive(1, "h a");
+    f.receive(1, "h t");
+    f.advance(1000);
+    std::vector<std::string> replies = f.sentTo(1);
+    // Each guess supersedes the state before it, so only the last one is left
+    CHECK(replies.size() == 2);
+    if (replies.size() == 2) {
+        CHECK(replies[0].find("New Hangman game started") == 0);
+        CHECK(replies[1].find("Guessed letters: AET\n") != std::string::npos);
+    }
+
+    // A game-start broadcast, then a direct reply to the same node
+    f.receive(2, "ac new");
+    f.advance(1000);
+    f.receive(3, "ac join");
+    f.receive(2, "ac status");
+    f.advance(1000);
+    replies = f.sentTo(2);
+    CHECK(replies.size() >= 2);
+    if (replies.size() >= 2) {
+        CHECK(replies[replies.size() - 2].find("Game is starting") != std::string::npos);
+        CHECK(replies.back().find("Game Status") != std::string::npos);
+    }
+}
+
+// More rounds finish at once than the TX queue has slots: the scheduler holds
+// back rounds until there is room, so every player gets their result
+static void testEveryRoundResultIsDelivered()
+{
+    Fixture f;
+    const uint32_t games = 20;
+    for (uint32_t g = 0; g < games; g++) {
+        char join[32];
+        snprintf(join, sizeof(join), "ac join %u", 100 + 2 * g);
+        f.receive(100 + 2 * g, "ac new");
+        f.advance(50);
+        f.receive(101 + 2 * g, join);
+        f.advance(50);
+    }
+    f.advance(40000);
+
+    for (uint32_t player = 100; player < 100 + 2 * games; player++) {
+        bool delivered = false;
+        for (const std::string &reply : f.sentTo(player))
+            delivered |= reply.find("Round 1 Battle:") != std::string::npos;
+        CHECK(delivered);
+    }
+
+    sent.clear();
+    f.receive(100, "gamestats");
+    f.advance(1000);
+    bool noneDropped = false;
+    for (const std::string &reply : f.sentTo(100))
+        noneDropped |= reply.find(" 0 dropped") != std::string::npos;
+    CHECK(noneDropped);
+}
+
+// Arguments outside the slot, board or id range get the usage error rather
+// than wrapping around to a valid index when narrowed
+static void testOutOfRangeArgumentsAreRejected()
+{
+    Fixture f;
+    f.receive(1, "ac new");
+    f.advance(1000);
+    const char *commands[] = {"ac buy 4294967296",     "ac buy 5",
+                              "ac sell 4294967296",    "ac place 0 4294967296",
+                              "ac place 4294967296 0", "ac place 0 9"};
+    for (const char *command : commands) {
+        sent.clear();
+        CHECK(f.receive(1, command) == ProcessMessage::STOP);
+        f.advance(1000);
+        std::vector<std::string> replies = f.sentTo(1);
+        CHECK(replies.size() == 1 && replies[0].find("Usage: ac ") != std::string::npos);
+    }
+
+    sent.clear();
+    f.receive(2, "ac join -1");
+    f.receive(3, "ac join 4294967297");
+    f.advance(1000);
+    CHECK(f.sentTo(2).size() == 1 && f.sentTo(2)[0] == "Invalid game ID. Usage: ac join [game_id]");
+    CHECK(f.sentTo(3).size() == 1 && f.sentTo(3)[0] == "Invalid game ID. Usage: ac join [game_id]");
+}
+
+struct Test {
+    const char *name;
+    void (*run)();
+};
+
+static const Test TESTS[] = {
+    {"chat is not a command", testChatIsNotACommand},
+    {"chat starting with a verb is rejected early", testChatStartingWithAVerbIsRejectedEarly},
+    {"binary port preference", testBinaryPortPreference},
+    {"lobby matches the oldest open game", testLobbyMatchesOldestOpenGame},
+    {"autochess updates are deltas", testAutoChessUpdatesAreDeltas},
+    {"binary replies carry game state", testBinaryRepliesCarryGameState},
+#if ARCH_PORTDUINO
+    {"hangman dictionary loads", testHangmanDictionaryLoads},
+#endif
+    {"binary clients fill free slots first", testBinaryClientsFillFreeSlotsFirst},
+    {"timer wheel catches up after idle", testTimerWheelCatchesUpAfterIdle},
+    {"replies do not allocate", testRepliesDoNotAllocate},
+    {"hard bot plays perfectly", testHardBotPlaysPerfectly},
+    {"render cache survives compaction", testRenderCacheSurvivesCompaction},
+    {"battle logs are per game", testBattleLogsArePerGame},
+    {"battle logs keep recent rounds", testBattleLogsKeepRecentRounds},
+    {"replies coalesce within the window", testRepliesCoalesceWithinTheWindow},
+    {"state updates supersede queued ones", testStateUpdatesSupersedeQueuedOnes},
+    {"replies to one node keep their order", testRepliesToOneNodeKeepTheirOrder},
+    {"every round result is delivered", testEveryRoundResultIsDelivered},
+    {"out of range arguments are rejected", testOutOfRangeArgumentsAreRejected},
+};
+
+int main()
+{
+    for (const Test &test : TESTS) {
+        int before = failures;
+        test.run();
+        printf("%s %s\n", failures == before ? "ok  " : "FAIL", test.name);
+    }
+    printf("%zu tests, %d failures\n", sizeof(TESTS) / sizeof(TESTS[0]), failures);
+    return failures ? 1 : 0;
+}
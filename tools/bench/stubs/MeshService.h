@@ -0,0 +1,13 @@
+#pragma once
+// Host stand-in for MeshService: the harness counts and frees what is sent
+#include "SinglePortModule.h"
+
+enum RxSource { RX_SRC_LOCAL };
+
+class MeshService
+{
+  public:
+    void sendToMesh(meshtastic_MeshPacket *p, RxSource src = RX_SRC_LOCAL, bool ccToPhone = false);
+};
+
+extern MeshService *service;
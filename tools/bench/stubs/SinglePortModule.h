@@ -0,0 +1,73 @@
+#pragma once
+// Host stand-in for the firmware's SinglePortModule and the protobuf types
+// GamesModule touches. Only the fields the module uses are declared.
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define meshtastic_Constants_DATA_PAYLOAD_LEN 233
+
+typedef uint32_t NodeNum;
+#define NODENUM_BROADCAST 0xFFFFFFFF
+
+typedef enum {
+    meshtastic_PortNum_TEXT_MESSAGE_APP = 1,
+    meshtastic_PortNum_PRIVATE_APP = 256,
+} meshtastic_PortNum;
+
+struct meshtastic_Data_payload_t {
+    uint16_t size;
+    uint8_t bytes[meshtastic_Constants_DATA_PAYLOAD_LEN];
+};
+
+struct meshtastic_Data {
+    meshtastic_PortNum portnum;
+    meshtastic_Data_payload_t payload;
+};
+
+struct meshtastic_MeshPacket {
+    uint32_t from;
+    uint32_t to;
+    uint8_t channel;
+    meshtastic_Data decoded;
+    uint32_t id;
+    uint8_t hop_limit;
+    bool want_ack;
+    uint8_t hop_start;
+};
+
+enum class ProcessMessage { CONTINUE = 0, STOP = 1 };
+
+class MeshModule
+{
+  public:
+    explicit MeshModule(const char *) {}
+    virtual ~MeshModule() {}
+
+  protected:
+    const meshtastic_MeshPacket *currentRequest = nullptr;
+
+    virtual meshtastic_MeshPacket *allocReply() { return nullptr; }
+    virtual ProcessMessage handleReceived(const meshtastic_MeshPacket &) { return ProcessMessage::CONTINUE; }
+    virtual bool wantPacket(const meshtastic_MeshPacket *) { return true; }
+};
+
+// Provided by the harness, in place of the firmware packet pool
+meshtastic_MeshPacket *hostAllocPacket();
+
+class SinglePortModule : public MeshModule
+{
+  public:
+    SinglePortModule(const char *name, meshtastic_PortNum portNum) : MeshModule(name), ourPortNum(portNum) {}
+
+  protected:
+    meshtastic_PortNum ourPortNum;
+
+    meshtastic_MeshPacket *allocDataPacket()
+    {
+        meshtastic_MeshPacket *p = hostAllocPacket();
+        p->decoded.portnum = ourPortNum;
+        return p;
+    }
+};
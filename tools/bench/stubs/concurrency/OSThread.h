@@ -0,0 +1,54 @@
+#pragma once
+// Host stand-in for the cooperative OSThread scheduler. Threads register
+// themselves; the harness calls runDue() as its virtual clock advances.
+#include "configuration.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+namespace concurrency
+{
+class OSThread
+{
+  public:
+    explicit OSThread(const char *, uint32_t period = 0) : nextRunMs(millis() + period) { all().push_back(this); }
+    virtual ~OSThread() { all().erase(std::find(all().begin(), all().end(), this)); }
+
+    bool enabled = true;
+
+    // Runs every enabled thread whose interval has elapsed
+    static void runDue(uint32_t now)
+    {
+        for (OSThread *thread : all()) {
+            if (!thread->enabled || static_cast<int32_t>(thread->nextRunMs - now) > 0)
+                continue;
+            int32_t next = thread->runOnce();
+            if (thread->enabled)
+                thread->nextRunMs = now + next;
+        }
+    }
+
+  protected:
+    virtual int32_t runOnce() = 0;
+
+    int32_t disable()
+    {
+        enabled = false;
+        return INT32_MAX;
+    }
+
+    void setInterval(unsigned long ms) { nextRunMs = millis() + ms; }
+    void setIntervalFromNow(unsigned long ms) { nextRunMs = millis() + ms; }
+    int32_t tillRun(uint32_t now) { return static_cast<int32_t>(nextRunMs - now); }
+
+  private:
+    uint32_t nextRunMs;
+
+    static std::vector<OSThread *> &all()
+    {
+        static std::vector<OSThread *> threads;
+        return threads;
+    }
+};
+} // namespace concurrency
@@ -0,0 +1,15 @@
+#pragma once
+// Host stand-ins for the Arduino clock, random() and the logging macros. The
+// harness provides a virtual clock and a seeded random() so runs repeat.
+#include <cstdint>
+
+uint32_t millis();
+long random(long max);
+long random(long min, long max);
+
+// Logs are dropped unless the harness runs with --verbose
+void hostLog(const char *format, ...) __attribute__((format(printf, 1, 2)));
+#define LOG_DEBUG(...) hostLog(__VA_ARGS__)
+#define LOG_INFO(...) hostLog(__VA_ARGS__)
+#define LOG_WARN(...) hostLog(__VA_ARGS__)
+#define LOG_ERROR(...) hostLog(__VA_ARGS__)
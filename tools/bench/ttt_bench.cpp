@@ -0,0 +1,199 @@
+// Micro-benchmark for the Tic Tac Toe end-of-move check. Compares the bitboard
+// engine in GamesModule.h (two 9-bit masks, AND against TTT_WIN_MASKS,
+// popcount for the draw) with the engine it replaced, which kept a char[9]
+// board and rescanned every row, column and diagonal. Both run over every
+// legal position, and the tool fails if they ever disagree. Timings are the
+// best of several passes; --baseline warns when the speedup drops well below
+// the one recorded in the baselines file.
+//
+// Build and run from the repository root:
+//   g++ -std=gnu++17 -O2 -Itools/bench/stubs -I. -o ttt_bench tools/bench/ttt_bench.cpp
+//   ./ttt_bench --baseline tools/bench/baselines.txt
+//
+// Usage:
+//   ttt_bench [--repeat R] [--baseline FILE]
+
+#include "GamesModule.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// The replaced engine, as it was before the boards became bitmasks
+
+struct CharBoard {
+    char board[9];
+};
+
+static bool charBoardWin(const CharBoard &game)
+{
+    // Check rows
+    for (int i = 0; i < 9; i += 3) {
+        if (game.board[i] != ' ' && game.board[i] == game.board[i+1] && game.board[i] == game.board[i+2])
+            return true;
+    }
+
+    // Check columns
+    for (int i = 0; i < 3; i++) {
+        if (game.board[i] != ' ' && game.board[i] == game.board[i+3] && game.board[i] == game.board[i+6])
+            return true;
+    }
+
+    // Check diagonals
+    if (game.board[0] != ' ' && game.board[0] == game.board[4] && game.board[0] == game.board[8])
+        return true;
+    if (game.board[2] != ' ' && game.board[2] == game.board[4] && game.board[2] == game.board[6])
+        return true;
+
+    return false;
+}
+
+static bool charBoardDraw(const CharBoard &game)
+{
+    for (int i = 0; i < 9; i++) {
+        if (game.board[i] == ' ')
+            return false;
+    }
+    return true;
+}
+
+// The bitboard engine, as GamesModule::ticTacToeEnd runs it
+
+struct MaskBoard {
+    uint16_t xMask;
+    uint16_t oMask;
+};
+
+static bool maskBoardWin(const MaskBoard &game)
+{
+    return hasTicTacToeLine(game.xMask) || hasTicTacToeLine(game.oMask);
+}
+
+static bool maskBoardDraw(const MaskBoard &game)
+{
+    return __builtin_popcount(game.xMask | game.oMask) == 9;
+}
+
+// Every position with as many X as O, or one more X
+static void legalPositions(std::vector<CharBoard> &chars, std::vector<MaskBoard> &masks)
+{
+    for (int index = 0; index < 19683; index++) {
+        CharBoard c;
+        MaskBoard m = {0, 0};
+        int xs = 0, os = 0;
+        for (int i = 0, rest = index; i < 9; i++, rest /= 3) {
+            c.board[i] = " XO"[rest % 3];
+            if (rest % 3 == 1) {
+                m.xMask |= 1u << i;
+                xs++;
+            } else if (rest % 3 == 2) {
+                m.oMask |= 1u << i;
+                os++;
+            }
+        }
+        if (xs == os || xs == os + 1) {
+            chars.push_back(c);
+            masks.push_back(m);
+        }
+    }
+}
+
+// Runs check over every position repeat times, returning ns per position and
+// the number of finished positions in finished
+template <typename Board, typename Check>
+static double timeEngine(const std::vector<Board> &boards, int repeat, Check check, long &finished)
+{
+    auto start = std::chrono::steady_clock::now();
+    finished = 0;
+    for (int r = 0; r < repeat; r++) {
+        for (const Board &board : boards) {
+            // Hide the board from the optimiser so every pass does the work
+            const Board *p = &board;
+            asm volatile("" : "+r"(p));
+            finished += check(*p);
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (double(boards.size()) * repeat);
+}
+
+// The speedup recorded for the bitboard engine, from a "ttt_engine SPEEDUP" line
+static double readBaseline(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+    char line[128];
+    double speedup = 0, value;
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "ttt_engine %lf", &value) == 1)
+            speedup = value;
+    }
+    fclose(in);
+    return speedup;
+}
+
+int main(int argc, char **argv)
+{
+    int repeat = 2000;
+    const char *baselinePath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--repeat R] [--baseline FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<CharBoard> chars;
+    std::vector<MaskBoard> masks;
+    legalPositions(chars, masks);
+
+    for (size_t i = 0; i < chars.size(); i++) {
+        if (charBoardWin(chars[i]) != maskBoardWin(masks[i]) || charBoardDraw(chars[i]) != maskBoardDraw(masks[i])) {
+            fprintf(stderr, "Engines disagree on position %zu\n", i);
+            return 1;
+        }
+    }
+
+    // Alternate the engines and keep each one's best pass, so a busy moment
+    // on the machine does not decide the result
+    const int PASSES = 5;
+    long charFinished, maskFinished;
+    double charNs = 0, maskNs = 0;
+    for (int pass = 0; pass < PASSES; pass++) {
+        double ns = timeEngine(chars, repeat, [](const CharBoard &b) { return charBoardWin(b) || charBoardDraw(b); },
+                               charFinished);
+        charNs = (pass == 0 || ns < charNs) ? ns : charNs;
+        ns = timeEngine(masks, repeat, [](const MaskBoard &b) { return maskBoardWin(b) || maskBoardDraw(b); },
+                        maskFinished);
+        maskNs = (pass == 0 || ns < maskNs) ? ns : maskNs;
+        if (charFinished != maskFinished) {
+            fprintf(stderr, "Engines disagree on the finished count\n");
+            return 1;
+        }
+    }
+
+    printf("%zu positions x %d repeats, %ld finished\n", chars.size(), repeat, charFinished / repeat);
+    printf("%-10s %6s %10s\n", "engine", "bytes", "ns/check");
+    printf("%-10s %6zu %10.2f\n", "char[9]", sizeof(CharBoard), charNs);
+    printf("%-10s %6zu %10.2f\n", "bitboard", sizeof(MaskBoard), maskNs);
+    printf("ttt_engine %.2f\n", charNs / maskNs);
+    if (!baselinePath)
+        return 0;
+
+    // Timings depend on the machine, so like games_bench latency this only warns
+    double expected = readBaseline(baselinePath);
+    if (expected == 0)
+        printf("ttt_engine: no baseline\n");
+    else if (charNs / maskNs < expected * 0.8)
+        printf("ttt_engine: warning: speedup %.2f, baseline %.2f\n", charNs / maskNs, expected);
+    printf("Baseline check passed\n");
+    return 0;
+}